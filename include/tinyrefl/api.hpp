@@ -3,10 +3,16 @@
 
 #include <algorithm>
 #include <cassert>
+#include <cstdint>
 #include <ctti/detailed_nameof.hpp>
+#include <ctti/nameof.hpp>
 #include <ctti/type_tag.hpp>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
 #include <nlohmann/json.hpp>
 #include <sstream>
+#include <string>
 #include <tinyrefl/backend.hpp>
 #include <tinyrefl/utils/typename.hpp>
 
@@ -62,6 +68,66 @@ constexpr bool has_metadata()
     return tinyrefl::backend::metadata_registered_for_type<T>::value;
 }
 
+// Facets of the metadata of T (name_type, member_variables, attributes...),
+// available without instantiating the full metadata
+template<typename T>
+using facets = tinyrefl::backend::metadata_facets_of_type<T>;
+
+template<typename T>
+constexpr ctti::name_t name_of()
+{
+    return tinyrefl::backend::string_constant<
+        typename facets<T>::name_type>();
+}
+
+// Index of a member variable of Class in its member_variables list, looked
+// up by name at compile time. Returns the number of member variables of the
+// class if there's no member variable with that name
+template<typename Class>
+constexpr std::size_t member_index(const ctti::detail::cstring& name)
+{
+    return tinyrefl::backend::member_index<
+        typename facets<Class>::member_variables>(name);
+}
+
+template<typename Class, ctti::detail::hash_t Hash>
+constexpr std::size_t member_index()
+{
+    return tinyrefl::backend::member_index<
+        typename facets<Class>::member_variables>(Hash);
+}
+
+template<typename Class>
+constexpr bool has_member_variable(const ctti::detail::cstring& name)
+{
+    return member_index<Class>(name) !=
+           facets<Class>::member_variables::size;
+}
+
+// Reference to the member variable with the given name of an object, as in
+// tinyrefl::get<"member"_id>(object)
+template<ctti::detail::hash_t Hash, typename Class>
+constexpr decltype(auto) get(Class& object)
+{
+    using variables =
+        typename facets<std::remove_const_t<Class>>::member_variables;
+    constexpr std::size_t index =
+        member_index<std::remove_const_t<Class>, Hash>();
+    static_assert(
+        index < variables::size, "Class has no member variable with that name");
+
+    return tinyrefl::meta::get_t<index, variables>().get(object);
+}
+
+template<typename T>
+using layout = typename tinyrefl::backend::layout_of_type<T>;
+
+template<typename T>
+constexpr bool has_layout()
+{
+    return tinyrefl::backend::layout_registered_for_type<T>::value;
+}
+
 template<ctti::detail::hash_t Hash>
 constexpr bool has_entity_metadata()
 {
@@ -73,6 +139,37 @@ template<ctti::detail::hash_t Hash>
 using entity_metadata =
     tinyrefl::backend::metadata_of_entity<TINYREFL_STATIC_VALUE(Hash)>;
 
+template<typename T>
+constexpr std::size_t entity_id()
+{
+    return tinyrefl::backend::entity_id<metadata<T>>();
+}
+
+template<ctti::detail::hash_t Hash>
+constexpr std::size_t entity_id()
+{
+    return tinyrefl::backend::entity_id_of_name<TINYREFL_STATIC_VALUE(
+        Hash)>::value;
+}
+
+template<typename Metadata>
+constexpr std::size_t entity_id(const Metadata&)
+{
+    return tinyrefl::backend::entity_id<Metadata>();
+}
+
+template<typename T>
+constexpr bool has_entity_id()
+{
+    return entity_id<T>() != tinyrefl::backend::invalid_entity_id;
+}
+
+template<ctti::detail::hash_t Hash>
+constexpr bool has_entity_id()
+{
+    return entity_id<Hash>() != tinyrefl::backend::invalid_entity_id;
+}
+
 namespace literals
 {
 
@@ -95,7 +192,8 @@ template<typename T>
 constexpr auto has_attribute(const ctti::detail::cstring& attribute)
     -> tinyrefl::meta::enable_if_t<has_metadata<T>(), bool>
 {
-    return tinyrefl::backend::has_attribute(metadata<T>{}, attribute);
+    return tinyrefl::backend::has_attribute(
+        typename facets<T>::attributes{}, attribute);
 }
 
 template<typename T>
@@ -108,8 +206,10 @@ constexpr auto has_attribute(const ctti::detail::cstring & /* attribute */)
 template<typename T>
 std::string default_object_name(const T& object)
 {
-    return "<" << tinyrefl::utils::type_name<T>() << " object @" << &object
-               << ">";
+    std::ostringstream os;
+    os << "<" << tinyrefl::utils::type_name_view<T>() << " object @"
+       << &object << ">";
+    return os.str();
 }
 
 namespace detail
@@ -118,6 +218,19 @@ namespace detail
 template<typename Functions>
 struct overloaded_function;
 
+#if defined(__cpp_variadic_using) && __cpp_variadic_using >= 201611L
+template<typename... Functions>
+struct overloaded_function<tinyrefl::meta::list<Functions...>>
+    : public Functions...
+{
+    using Functions::operator()...;
+
+    constexpr overloaded_function(Functions... functions)
+        : Functions{functions}...
+    {
+    }
+};
+#else
 template<typename Head, typename Second, typename... Tail>
 struct overloaded_function<tinyrefl::meta::list<Head, Second, Tail...>>
     : public Head,
@@ -135,20 +248,6 @@ struct overloaded_function<tinyrefl::meta::list<Head, Second, Tail...>>
     }
 };
 
-template<typename Function, typename Args, typename = void>
-struct is_invokable : public std::false_type
-{
-};
-
-template<typename Function, typename... Args>
-struct is_invokable<
-    Function,
-    tinyrefl::meta::list<Args...>,
-    tinyrefl::meta::void_t<typename std::result_of<Function(Args...)>::type>>
-    : std::true_type
-{
-};
-
 template<typename Head>
 struct overloaded_function<tinyrefl::meta::list<Head>> : public Head
 {
@@ -156,6 +255,7 @@ struct overloaded_function<tinyrefl::meta::list<Head>> : public Head
 
     using Head::operator();
 };
+#endif // __cpp_variadic_using
 
 template<typename... Ts, typename Function, std::size_t... Indices>
 auto tuple_map_impl(
@@ -173,20 +273,10 @@ auto tuple_map(const std::tuple<Ts...>& tuple, Function function)
         tuple, function, tinyrefl::meta::make_index_sequence_for<Ts...>());
 }
 
-template<typename... Ts, std::size_t... Indices>
-constexpr auto typelist_to_tuple_impl(
-    tinyrefl::meta::list<Ts...>, tinyrefl::meta::index_sequence<Indices...>)
-{
-    return std::make_tuple(
-        tinyrefl::type_tag<tinyrefl::meta::pack_get_t<Indices, Ts...>>{}...);
-}
-
 template<typename... Ts>
 constexpr auto typelist_to_tuple(tinyrefl::meta::list<Ts...>)
 {
-    return typelist_to_tuple_impl(
-        tinyrefl::meta::list<Ts...>{},
-        tinyrefl::meta::make_index_sequence_for<Ts...>{});
+    return std::make_tuple(tinyrefl::type_tag<Ts>{}...);
 }
 
 template<typename First, typename Second, typename... Tail, typename Comparator>
@@ -255,7 +345,7 @@ tinyrefl::meta::enable_if_t<
         ctti::static_value<entity, ClassKind>)
 {
     visitor(
-        tinyrefl::utils::type_name<Class>(),
+        tinyrefl::utils::type_name_view<Class>(),
         tinyrefl::meta::size_t<Depth>(),
         tinyrefl::type_tag<Class>(),
         TINYREFL_STATIC_VALUE(ClassKind)());
@@ -281,7 +371,7 @@ tinyrefl::meta::enable_if_t<
         });
 
     visitor(
-        tinyrefl::utils::type_name<Class>(),
+        tinyrefl::utils::type_name_view<Class>(),
         tinyrefl::meta::size_t<Depth>(),
         tinyrefl::type_tag<Class>(),
         TINYREFL_STATIC_VALUE(ClassKind)());
@@ -291,7 +381,7 @@ tinyrefl::meta::enable_if_t<
             using ctor = typename decltype(Ctor)::type;
 
             visitor(
-                ctor::name.str(),
+                ctor::name,
                 tinyrefl::meta::size_t<Depth>(),
                 ctor(),
                 TINYREFL_STATIC_VALUE(entity::CONSTRUCTOR)());
@@ -302,7 +392,7 @@ tinyrefl::meta::enable_if_t<
             using member = typename decltype(Member)::type;
 
             visitor(
-                member::name.name().str(),
+                member::name.name(),
                 tinyrefl::meta::size_t<Depth>(),
                 member(),
                 TINYREFL_STATIC_VALUE(entity::MEMBER_VARIABLE)());
@@ -313,7 +403,7 @@ tinyrefl::meta::enable_if_t<
             using member = typename decltype(Member)::type;
 
             visitor(
-                member::name.name().str(),
+                member::name.name(),
                 tinyrefl::meta::size_t<Depth>(),
                 member(),
                 TINYREFL_STATIC_VALUE(entity::MEMBER_FUNCTION)());
@@ -324,7 +414,7 @@ tinyrefl::meta::enable_if_t<
             using class_type = typename decltype(class_)::type;
 
             visitor(
-                ctti::detailed_nameof<class_type>().name().str(),
+                ctti::detailed_nameof<class_type>().name(),
                 tinyrefl::meta::size_t<Depth>(),
                 class_,
                 TINYREFL_STATIC_VALUE(entity::MEMBER_CLASS)());
@@ -335,7 +425,7 @@ tinyrefl::meta::enable_if_t<
             using enum_type = typename decltype(enum_)::type;
 
             visitor(
-                ctti::detailed_nameof<enum_type>().name().str(),
+                ctti::detailed_nameof<enum_type>().name(),
                 tinyrefl::meta::size_t<Depth>(),
                 enum_,
                 TINYREFL_STATIC_VALUE(entity::MEMBER_ENUM)());
@@ -376,14 +466,39 @@ auto overloaded_function(Functions... functions)
 namespace detail
 {
 
-template<typename Function>
+// Converts from anything, so the function_fallback overloads need a user
+// defined conversion for each argument and lose against any visitor that
+// can be called with the arguments
+struct any_argument
+{
+    template<typename T>
+    constexpr any_argument(T&& /* arg */)
+    {
+    }
+};
+
+// Does nothing when no other overload can be called with the arguments.
+// The fallback is picked by overload resolution, with no SFINAE checks to
+// find out whether the other overloads are callable
 struct function_fallback
 {
+    // Any number of arguments other than the one to four that visitors
+    // take. The pack makes it less specialized than any visitor with a
+    // fixed number of parameters, and non template visitors win ties
     template<typename... Args>
-    constexpr auto operator()(Args&&... args) const
-        -> std::enable_if_t<!tinyrefl::detail::is_invokable<
-            Function,
-            tinyrefl::meta::list<decltype(std::forward<Args>(args))...>>::value>
+    constexpr auto operator()(Args&&...) const
+        -> std::enable_if_t<sizeof...(Args) == 0 || (sizeof...(Args) > 4)>
+    {
+    }
+
+    constexpr void operator()(any_argument) const {}
+    constexpr void operator()(any_argument, any_argument) const {}
+    constexpr void
+        operator()(any_argument, any_argument, any_argument) const
+    {
+    }
+    constexpr void operator()(
+        any_argument, any_argument, any_argument, any_argument) const
     {
     }
 };
@@ -392,11 +507,13 @@ struct function_fallback
 template<typename... Functions>
 auto overloaded_function_default(Functions... functions)
 {
-    using overloaded_t = overloaded_function_t<Functions...>;
     return overloaded_function(
-        functions..., tinyrefl::detail::function_fallback<overloaded_t>{});
+        functions..., tinyrefl::detail::function_fallback{});
 }
 
+// Visitors get entity names as ctti::detail::cstring views of static
+// strings, so visitation does not allocate. Visitors taking names as
+// const std::string& still work, paying the conversion
 template<typename Class, typename... Visitors>
 void visit_class(Visitors... visitors)
 {
@@ -412,9 +529,9 @@ void visit_object(const Class& object, Visitors... visitors)
     auto visitor = tinyrefl::overloaded_function_default(visitors...);
 
     visit_class<typename std::decay<Class>::type>(
-        [&](const std::string& name,
-            auto               depth,
-            auto               entity,
+        [&](const ctti::detail::cstring& name,
+            auto                         depth,
+            auto                         entity,
             TINYREFL_STATIC_VALUE(tinyrefl::entity::BASE_CLASS)) {
             visitor(
                 name,
@@ -422,9 +539,9 @@ void visit_object(const Class& object, Visitors... visitors)
                 tinyrefl::detail::cast<typename decltype(entity)::type>(object),
                 TINYREFL_STATIC_VALUE(tinyrefl::entity::OBJECT)());
         },
-        [&](const std::string& name,
-            auto               depth,
-            auto               entity,
+        [&](const ctti::detail::cstring& name,
+            auto                         depth,
+            auto                         entity,
             TINYREFL_STATIC_VALUE(tinyrefl::entity::MEMBER_VARIABLE)) {
             visitor(
                 name,
@@ -440,9 +557,9 @@ void visit_object(Class& object, Visitors... visitors)
     auto visitor = tinyrefl::overloaded_function_default(visitors...);
 
     visit_class<typename std::decay<Class>::type>(
-        [&](const std::string& name,
-            auto               depth,
-            auto               entity,
+        [&](const ctti::detail::cstring& name,
+            auto                         depth,
+            auto                         entity,
             TINYREFL_STATIC_VALUE(tinyrefl::entity::BASE_CLASS)) {
             visitor(
                 name,
@@ -450,9 +567,9 @@ void visit_object(Class& object, Visitors... visitors)
                 tinyrefl::detail::cast<typename decltype(entity)::type>(object),
                 TINYREFL_STATIC_VALUE(tinyrefl::entity::OBJECT)());
         },
-        [&](const std::string& name,
-            auto               depth,
-            auto               entity,
+        [&](const ctti::detail::cstring& name,
+            auto                         depth,
+            auto                         entity,
             TINYREFL_STATIC_VALUE(tinyrefl::entity::MEMBER_VARIABLE)) {
             visitor(
                 name,
@@ -470,9 +587,9 @@ auto visit_objects(const std::tuple<Class...>& objects, Visitors... visitors)
     visit_class<
         typename std::decay<tinyrefl::meta::pack_head_t<Class...>>::type>(
         [&objects, visitor](
-            const std::string& name,
-            auto               depth,
-            auto               entity,
+            const ctti::detail::cstring& name,
+            auto                         depth,
+            auto                         entity,
             TINYREFL_STATIC_VALUE(tinyrefl::entity::BASE_CLASS)) {
             visitor(
                 name,
@@ -487,9 +604,9 @@ auto visit_objects(const std::tuple<Class...>& objects, Visitors... visitors)
                 TINYREFL_STATIC_VALUE(tinyrefl::entity::OBJECT)());
         },
         [&objects, visitor](
-            const std::string& name,
-            auto               depth,
-            auto               entity,
+            const ctti::detail::cstring& name,
+            auto                         depth,
+            auto                         entity,
             TINYREFL_STATIC_VALUE(tinyrefl::entity::MEMBER_VARIABLE)) {
             visitor(
                 name,
@@ -512,31 +629,31 @@ auto visit_objects(Class&&... objects)
             auto... visitors) { return visit_objects(objects, visitors...); };
 }
 
+// Member variable visitation folds over the flattened member variables of
+// the class and its bases, with no recursion through the class hierarchy
 template<typename Class, typename... Visitors>
 void visit_member_variables(const Class& object, Visitors... visitors)
 {
-    visit_object(
-        object,
-        [visitor = overloaded_function(visitors...)](
-            const auto& name,
-            auto /* depth */,
-            const auto& member,
-            TINYREFL_STATIC_VALUE(entity::MEMBER_VARIABLE)) {
-            visitor(name, member);
+    auto visitor = overloaded_function(visitors...);
+
+    tinyrefl::meta::foreach<
+        typename tinyrefl::metadata<Class>::all_member_variables>(
+        [&object, &visitor](auto Member, auto /* Index */) {
+            using member = typename decltype(Member)::type;
+            visitor(member::name.name(), member().get(object));
         });
 }
 
 template<typename Class, typename... Visitors>
 void visit_member_variables(Class& object, Visitors... visitors)
 {
-    visit_object(
-        object,
-        [visitor = overloaded_function(visitors...)](
-            const auto& name,
-            auto /* depth */,
-            auto& member,
-            TINYREFL_STATIC_VALUE(entity::MEMBER_VARIABLE)) {
-            visitor(name, member);
+    auto visitor = overloaded_function(visitors...);
+
+    tinyrefl::meta::foreach<
+        typename tinyrefl::metadata<Class>::all_member_variables>(
+        [&object, &visitor](auto Member, auto /* Index */) {
+            using member = typename decltype(Member)::type;
+            visitor(member::name.name(), member().get(object));
         });
 }
 
@@ -545,24 +662,126 @@ auto visit_objects_member_variables(Class&&... objects)
 {
     return [objects = std::forward_as_tuple(std::forward<Class>(objects)...)](
                auto... visitors) {
-        auto make_visitor = [](auto visitor) {
-            return [visitor](
-                       const auto& name,
-                       auto /* depth */,
-                       auto&& entities,
-                       TINYREFL_STATIC_VALUE(entity::MEMBER_VARIABLE)) {
-                visitor(name, entities);
-            };
-        };
-
-        return visit_objects(objects, make_visitor(visitors)...);
+        using class_type =
+            std::decay_t<tinyrefl::meta::pack_head_t<Class...>>;
+        auto visitor = overloaded_function(visitors...);
+
+        tinyrefl::meta::foreach<
+            typename tinyrefl::metadata<class_type>::all_member_variables>(
+            [&objects, &visitor](auto Member, auto /* Index */) {
+                using member = typename decltype(Member)::type;
+
+                visitor(
+                    member::name.name(),
+                    tinyrefl::detail::tuple_map(
+                        objects, [](auto&& object) -> decltype(auto) {
+                            return member().get(
+                                std::forward<decltype(object)>(object));
+                        }));
+            });
     };
 }
 
+// Type erased description of a member variable. Compact visitation walks a
+// constexpr table of descriptors per class in a single non template loop,
+// trading an indirect call per member for much less generated code
+struct field_descriptor
+{
+    ctti::detail::cstring name;
+    // Hash of the type name of the member, as in ctti::nameof<T>().hash()
+    ctti::detail::hash_t type_id;
+    std::size_t          size;
+    // Returns the address of the member in an object of the class
+    void* (*get)(void* object);
+};
+
+namespace detail
+{
+
+template<typename Class, typename Member>
+void* field_address(void* object)
+{
+    return std::addressof(Member().get(*static_cast<Class*>(object)));
+}
+
+template<typename Class>
+struct field_descriptor_of
+{
+    template<typename Member>
+    using field_type = typename tinyrefl::backend::member_pointer_traits<
+        typename Member::pointer_type>::member_type;
+
+    template<typename Member>
+    static constexpr field_descriptor element()
+    {
+        return {Member::name.name(),
+                ctti::nameof<field_type<Member>>().hash(),
+                sizeof(field_type<Member>),
+                &field_address<Class, Member>};
+    }
+
+    static constexpr field_descriptor sentinel()
+    {
+        return {"", 0, 0, nullptr};
+    }
+};
+
+template<typename Class, typename Members>
+using field_table = tinyrefl::backend::
+    static_table<field_descriptor, field_descriptor_of<Class>, Members>;
+
+using field_visitor =
+    void (*)(void* visitor, const field_descriptor& field, void* value);
+
+inline void visit_fields(
+    const tinyrefl::backend::array_view<field_descriptor>& fields,
+    void*                                                  object,
+    void*                                                  visitor,
+    field_visitor                                          visit)
+{
+    for(const field_descriptor& field : fields)
+    {
+        visit(visitor, field, field.get(object));
+    }
+}
+} // namespace detail
+
+// Descriptors of the member variables of the class and its reflected base
+// classes, in the same order as all_member_variables
+template<typename Class>
+constexpr tinyrefl::backend::array_view<field_descriptor> fields()
+{
+    using table = detail::field_table<
+        Class,
+        typename tinyrefl::metadata<Class>::all_member_variables>;
+
+    return {table::values, table::values + table::count};
+}
+
+// Compact member variable visitation: The visitor is called with the
+// descriptor and the address of each member variable of the object, as
+// visitor(const field_descriptor& field, void* value) (const void* for
+// const objects). Only the visitor call is instantiated per visitor type
+template<typename Class, typename Visitor>
+void visit_fields(Class& object, Visitor visitor)
+{
+    using value_pointer =
+        std::conditional_t<std::is_const<Class>::value, const void*, void*>;
+
+    detail::visit_fields(
+        fields<std::remove_const_t<Class>>(),
+        const_cast<void*>(static_cast<const void*>(std::addressof(object))),
+        std::addressof(visitor),
+        [](void* visitor, const field_descriptor& field, void* value) {
+            (*static_cast<Visitor*>(visitor))(
+                field, static_cast<value_pointer>(value));
+        });
+}
+
 template<typename Class>
 auto make_tuple(const Class& object)
 {
-    using variables = typename tinyrefl::metadata<Class>::member_variables;
+    using variables = typename tinyrefl::facets<Class>::member_variables;
 
     return detail::tuple_map(
         detail::typelist_to_tuple(variables{}),
@@ -575,7 +794,7 @@ auto make_tuple(const Class& object)
 template<typename Class>
 constexpr auto make_tuple(Class& object)
 {
-    using variables = typename tinyrefl::metadata<Class>::member_variables;
+    using variables = typename tinyrefl::facets<Class>::member_variables;
 
     return detail::tuple_map(
         detail::typelist_to_tuple(variables{}),
@@ -590,8 +809,7 @@ Class make_object(const std::tuple<Ts...>& tuple)
 {
     Class result;
 
-    tinyrefl::meta::foreach<
-        typename tinyrefl::metadata<Class>::member_variables>(
+    tinyrefl::meta::foreach<typename tinyrefl::facets<Class>::member_variables>(
         [&tuple, &result](auto type, auto index) mutable {
             constexpr typename decltype(type)::type member_metadata;
             member_metadata.get(result) = std::get<index>(tuple);
@@ -633,6 +851,33 @@ auto enum_cast(const std::string& name) -> std::enable_if_t<
     return enum_cast<Enum>(ctti::detail::cstring{name.c_str(), name.size()});
 }
 
+template<typename Enum>
+constexpr auto enum_cast_case_insensitive(const ctti::detail::cstring name)
+    -> std::enable_if_t<
+        std::is_enum<Enum>::value && tinyrefl::has_metadata<Enum>(),
+        Enum>
+{
+    return tinyrefl::metadata<Enum>().get_value_case_insensitive(name).value();
+}
+
+template<typename Enum, std::size_t N>
+constexpr auto enum_cast_case_insensitive(const char (&name)[N])
+    -> std::enable_if_t<
+        std::is_enum<Enum>::value && tinyrefl::has_metadata<Enum>(),
+        Enum>
+{
+    return enum_cast_case_insensitive<Enum>(ctti::detail::cstring{name});
+}
+
+template<typename Enum>
+auto enum_cast_case_insensitive(const std::string& name) -> std::enable_if_t<
+    std::is_enum<Enum>::value && tinyrefl::has_metadata<Enum>(),
+    Enum>
+{
+    return enum_cast_case_insensitive<Enum>(
+        ctti::detail::cstring{name.c_str(), name.size()});
+}
+
 template<typename Enum>
 constexpr auto underlying_value(const Enum value) -> std::enable_if_t<
     std::is_enum<Enum>::value && tinyrefl::has_metadata<Enum>(),
@@ -641,6 +886,723 @@ constexpr auto underlying_value(const Enum value) -> std::enable_if_t<
     return tinyrefl::metadata<Enum>().get_value(value).underlying_value();
 }
 
+template<typename Enum>
+using raw_enum_values =
+    tinyrefl::backend::array_view<std::underlying_type_t<Enum>>;
+
+// Returns the index of the first raw value that is not an enumerated value
+// of Enum, or values.size() if all are valid
+template<typename Enum>
+auto validate_enum_values(const raw_enum_values<Enum>& values)
+    -> std::enable_if_t<
+        std::is_enum<Enum>::value && tinyrefl::has_metadata<Enum>(),
+        std::size_t>
+{
+    return tinyrefl::backend::find_non_enumerated_value<
+        tinyrefl::metadata<Enum>>(values);
+}
+
+template<typename Enum>
+auto validate_enum_values(
+    const std::underlying_type_t<Enum>* begin,
+    const std::underlying_type_t<Enum>* end)
+    -> std::enable_if_t<
+        std::is_enum<Enum>::value && tinyrefl::has_metadata<Enum>(),
+        std::size_t>
+{
+    return validate_enum_values<Enum>(raw_enum_values<Enum>{begin, end});
+}
+
+// Sets bit i % 64 of mask[i / 64] if values[i] is an enumerated value of
+// Enum (mask must have room for values.size() bits). Returns the number of
+// invalid values
+template<typename Enum>
+auto validate_enum_values(
+    const raw_enum_values<Enum>& values, std::uint64_t* mask)
+    -> std::enable_if_t<
+        std::is_enum<Enum>::value && tinyrefl::has_metadata<Enum>(),
+        std::size_t>
+{
+    return tinyrefl::backend::enumerated_values_mask<tinyrefl::metadata<Enum>>(
+        values, mask);
+}
+
+namespace detail
+{
+
+constexpr std::size_t popcount(std::uint64_t word)
+{
+    // Recognized as a popcount instruction by GCC and Clang
+    std::size_t count = 0;
+
+    for(; word != 0; word &= word - 1)
+    {
+        ++count;
+    }
+
+    return count;
+}
+
+constexpr std::size_t lowest_bit(const std::uint64_t word)
+{
+    std::size_t bit = 0;
+
+    while(((word >> bit) & 1) == 0)
+    {
+        ++bit;
+    }
+
+    return bit;
+}
+
+template<typename Metadata>
+constexpr std::size_t max_flags_size()
+{
+    std::size_t size = 1;
+
+    for(std::size_t i = 0; i < Metadata().count(); ++i)
+    {
+        size += Metadata().get_value(i).name().size() + 1;
+    }
+
+    return size;
+}
+
+constexpr bool is_flags_space(const char c)
+{
+    return c == ' ' || c == '\t';
+}
+
+} // namespace detail
+
+// Set of values of a reflected enum, one bit per enumerated value (Bit i is
+// the i-th value of the enum metadata)
+template<typename Enum>
+class enum_set
+{
+    static_assert(
+        std::is_enum<Enum>::value && tinyrefl::has_metadata<Enum>(),
+        "enum_set<Enum> requires a reflected enum");
+
+    using metadata_type = tinyrefl::metadata<Enum>;
+
+public:
+    using value_type      = Enum;
+    using underlying_type = std::underlying_type_t<Enum>;
+
+    static constexpr std::size_t capacity   = metadata_type::values::size;
+    static constexpr std::size_t word_count = (capacity + 63) / 64;
+
+    // Max size of the buffer format() needs (Names, separators and the null
+    // terminator)
+    static constexpr std::size_t max_formatted_size =
+        detail::max_flags_size<metadata_type>();
+
+    class const_iterator
+    {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type        = Enum;
+        using difference_type   = std::ptrdiff_t;
+        using pointer           = const Enum*;
+        using reference         = Enum;
+
+        constexpr const_iterator(const enum_set* set, const std::size_t index)
+            : _set{set}, _index{set->next(index)}
+        {
+        }
+
+        constexpr Enum operator*() const
+        {
+            return metadata_type().get_value(_index).value();
+        }
+
+        constexpr const_iterator& operator++()
+        {
+            _index = _set->next(_index + 1);
+            return *this;
+        }
+
+        constexpr const_iterator operator++(int)
+        {
+            const_iterator previous = *this;
+            ++(*this);
+            return previous;
+        }
+
+        friend constexpr bool
+            operator==(const const_iterator& lhs, const const_iterator& rhs)
+        {
+            return lhs._index == rhs._index;
+        }
+
+        friend constexpr bool
+            operator!=(const const_iterator& lhs, const const_iterator& rhs)
+        {
+            return !(lhs == rhs);
+        }
+
+    private:
+        const enum_set* _set;
+        std::size_t     _index;
+    };
+
+    constexpr enum_set() : _words{} {}
+
+    constexpr enum_set(std::initializer_list<Enum> values) : _words{}
+    {
+        for(const Enum value : values)
+        {
+            insert(value);
+        }
+    }
+
+    static constexpr enum_set all()
+    {
+        return ~enum_set{};
+    }
+
+    // Set with the enumerated values whose bits are all set in flags (Zero
+    // valued enumerators are ignored)
+    static constexpr enum_set from_flags(const underlying_type flags)
+    {
+        enum_set result;
+
+        for(std::size_t i = 0; i < capacity; ++i)
+        {
+            const underlying_type value =
+                metadata_type().get_value(i).underlying_value();
+
+            if(value != 0 && (flags & value) == value)
+            {
+                result.set(i);
+            }
+        }
+
+        return result;
+    }
+
+    // Bitwise or of the underlying values of the values in the set
+    constexpr underlying_type to_flags() const
+    {
+        underlying_type flags = 0;
+
+        for(std::size_t i = next(0); i < capacity; i = next(i + 1))
+        {
+            flags |= metadata_type().get_value(i).underlying_value();
+        }
+
+        return flags;
+    }
+
+    // Parses a list of value names separated by separator ("A|B|C"),
+    // ignoring spaces around names. Returns false if a name is not an
+    // enumerated value, leaving result unchanged
+    static constexpr bool parse(
+        const ctti::detail::cstring& flags,
+        enum_set&                    result,
+        const char                   separator = '|')
+    {
+        enum_set    parsed;
+        std::size_t begin = 0;
+
+        while(begin <= flags.size())
+        {
+            std::size_t end = begin;
+
+            while(end < flags.size() && flags[end] != separator)
+            {
+                ++end;
+            }
+
+            std::size_t first = begin, last = end;
+
+            while(first < last && detail::is_flags_space(flags[first]))
+            {
+                ++first;
+            }
+            while(last > first && detail::is_flags_space(flags[last - 1]))
+            {
+                --last;
+            }
+
+            // An empty string is the empty set, but empty names between
+            // separators are not valid
+            if(first == last)
+            {
+                if(end < flags.size() || begin > 0)
+                {
+                    return false;
+                }
+            }
+            else
+            {
+                const std::size_t index = metadata_type().index_of(
+                    ctti::detail::cstring{flags.begin() + first, last - first});
+
+                if(index == capacity)
+                {
+                    return false;
+                }
+
+                parsed.set(index);
+            }
+
+            begin = end + 1;
+        }
+
+        result = parsed;
+        return true;
+    }
+
+    // Writes the names of the values in the set separated by separator, in
+    // metadata order, to buffer (Truncated to size - 1 chars and null
+    // terminated if size is not zero). Returns the length of the full string
+    std::size_t format(
+        char* buffer, const std::size_t size, const char separator = '|') const
+    {
+        std::size_t length = 0;
+
+        const auto put = [buffer, size, &length](const char c) {
+            if(length + 1 < size)
+            {
+                buffer[length] = c;
+            }
+
+            ++length;
+        };
+
+        for(std::size_t i = next(0); i < capacity; i = next(i + 1))
+        {
+            if(length > 0)
+            {
+                put(separator);
+            }
+
+            for(const char c : metadata_type().get_value(i).name())
+            {
+                put(c);
+            }
+        }
+
+        if(size > 0)
+        {
+            buffer[std::min(length, size - 1)] = '\0';
+        }
+
+        return length;
+    }
+
+    std::string str(const char separator = '|') const
+    {
+        char buffer[max_formatted_size];
+        const std::size_t length = format(buffer, sizeof(buffer), separator);
+        return {buffer, length};
+    }
+
+    constexpr bool contains(const Enum value) const
+    {
+        return test(metadata_type().index_of(value));
+    }
+
+    constexpr enum_set& insert(const Enum value)
+    {
+        const std::size_t index = metadata_type().index_of(value);
+
+        if(index < capacity)
+        {
+            set(index);
+        }
+
+        return *this;
+    }
+
+    constexpr enum_set& erase(const Enum value)
+    {
+        const std::size_t index = metadata_type().index_of(value);
+
+        if(index < capacity)
+        {
+            _words[index / 64] &= ~(std::uint64_t{1} << (index % 64));
+        }
+
+        return *this;
+    }
+
+    constexpr void clear()
+    {
+        for(std::size_t i = 0; i < word_count; ++i)
+        {
+            _words[i] = 0;
+        }
+    }
+
+    constexpr std::size_t size() const
+    {
+        std::size_t result = 0;
+
+        for(std::size_t i = 0; i < word_count; ++i)
+        {
+            result += detail::popcount(_words[i]);
+        }
+
+        return result;
+    }
+
+    constexpr bool empty() const
+    {
+        for(std::size_t i = 0; i < word_count; ++i)
+        {
+            if(_words[i] != 0)
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    constexpr const_iterator begin() const
+    {
+        return {this, 0};
+    }
+
+    constexpr const_iterator end() const
+    {
+        return {this, capacity};
+    }
+
+    constexpr enum_set& operator|=(const enum_set& other)
+    {
+        for(std::size_t i = 0; i < word_count; ++i)
+        {
+            _words[i] |= other._words[i];
+        }
+
+        return *this;
+    }
+
+    constexpr enum_set& operator&=(const enum_set& other)
+    {
+        for(std::size_t i = 0; i < word_count; ++i)
+        {
+            _words[i] &= other._words[i];
+        }
+
+        return *this;
+    }
+
+    constexpr enum_set& operator^=(const enum_set& other)
+    {
+        for(std::size_t i = 0; i < word_count; ++i)
+        {
+            _words[i] ^= other._words[i];
+        }
+
+        return *this;
+    }
+
+    constexpr enum_set& operator-=(const enum_set& other)
+    {
+        for(std::size_t i = 0; i < word_count; ++i)
+        {
+            _words[i] &= ~other._words[i];
+        }
+
+        return *this;
+    }
+
+    constexpr enum_set operator~() const
+    {
+        enum_set result;
+
+        for(std::size_t i = 0; i < word_count; ++i)
+        {
+            result._words[i] = ~_words[i];
+        }
+
+        if(capacity % 64 != 0)
+        {
+            result._words[word_count - 1] &=
+                (std::uint64_t{1} << (capacity % 64)) - 1;
+        }
+
+        return result;
+    }
+
+    friend constexpr enum_set operator|(enum_set lhs, const enum_set& rhs)
+    {
+        return lhs |= rhs;
+    }
+
+    friend constexpr enum_set operator&(enum_set lhs, const enum_set& rhs)
+    {
+        return lhs &= rhs;
+    }
+
+    friend constexpr enum_set operator^(enum_set lhs, const enum_set& rhs)
+    {
+        return lhs ^= rhs;
+    }
+
+    friend constexpr enum_set operator-(enum_set lhs, const enum_set& rhs)
+    {
+        return lhs -= rhs;
+    }
+
+    friend constexpr bool operator==(const enum_set& lhs, const enum_set& rhs)
+    {
+        for(std::size_t i = 0; i < word_count; ++i)
+        {
+            if(lhs._words[i] != rhs._words[i])
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    friend constexpr bool operator!=(const enum_set& lhs, const enum_set& rhs)
+    {
+        return !(lhs == rhs);
+    }
+
+private:
+    // One word for empty enums too
+    std::uint64_t _words[word_count > 0 ? word_count : 1];
+
+    constexpr bool test(const std::size_t index) const
+    {
+        return index < capacity &&
+               ((_words[index / 64] >> (index % 64)) & 1) != 0;
+    }
+
+    constexpr void set(const std::size_t index)
+    {
+        _words[index / 64] |= std::uint64_t{1} << (index % 64);
+    }
+
+    // Index of the first value in the set at or after index, capacity if none
+    constexpr std::size_t next(std::size_t index) const
+    {
+        while(index < capacity)
+        {
+            const std::uint64_t word = _words[index / 64] >> (index % 64);
+
+            if(word != 0)
+            {
+                return index + detail::lowest_bit(word);
+            }
+
+            index += 64 - index % 64;
+        }
+
+        return capacity;
+    }
+};
+
+template<typename Enum>
+constexpr std::size_t enum_set<Enum>::capacity;
+template<typename Enum>
+constexpr std::size_t enum_set<Enum>::word_count;
+template<typename Enum>
+constexpr std::size_t enum_set<Enum>::max_formatted_size;
+
+namespace detail
+{
+
+// Result of visiting each value if it is the same for all values (So
+// references are kept), their common type otherwise
+template<typename Head, typename... Tail>
+struct enum_visit_common_result
+{
+    using type = std::conditional_t<
+        std::is_same<
+            tinyrefl::meta::list<Head, Tail...>,
+            tinyrefl::meta::list<Tail..., Head>>::value,
+        Head,
+        std::common_type_t<Head, Tail...>>;
+};
+
+// Result of visiting the values, Empty if there are no values
+template<typename Visitor, typename Values, typename Empty>
+struct enum_visit_result;
+
+template<typename Visitor, typename... Values, typename Empty>
+struct enum_visit_result<Visitor, tinyrefl::meta::list<Values...>, Empty>
+{
+    using type = typename enum_visit_common_result<decltype(
+        std::declval<Visitor&>()(std::declval<Values>()))...>::type;
+};
+
+template<typename Visitor, typename Empty>
+struct enum_visit_result<Visitor, tinyrefl::meta::list<>, Empty>
+{
+    using type = Empty;
+};
+
+template<typename Visitor, typename Values, typename Empty = void>
+using enum_visit_result_t =
+    typename enum_visit_result<Visitor, Values, Empty>::type;
+
+// Enums with up to this number of values are visited through a chain of
+// comparisons, bigger enums through a table of functions
+constexpr std::size_t enum_visit_chain_max_size = 8;
+
+template<typename Result, typename Values>
+struct enum_visit_chain;
+
+// Empty enums have no values to compare with, all values are invalid
+template<typename Result>
+struct enum_visit_chain<Result, tinyrefl::meta::list<>>
+{
+    template<typename Enum, typename Visitor, typename Invalid>
+    static Result visit(const Enum value, Visitor&, Invalid& invalid)
+    {
+        return invalid(value);
+    }
+};
+
+// The first value that compares equal is visited, as enum_::index_of()
+// does with duplicated values
+template<typename Result, typename Head, typename... Tail>
+struct enum_visit_chain<Result, tinyrefl::meta::list<Head, Tail...>>
+{
+    template<typename Enum, typename Visitor, typename Invalid>
+    static Result
+        visit(const Enum value, Visitor& visitor, Invalid& invalid)
+    {
+        if(value == Head::value_static_value::value)
+        {
+            return visitor(Head{});
+        }
+        else
+        {
+            return enum_visit_chain<Result, tinyrefl::meta::list<Tail...>>::
+                visit(value, visitor, invalid);
+        }
+    }
+};
+
+template<typename Result, typename Value, typename Visitor>
+Result visit_enum_value(Visitor& visitor)
+{
+    return visitor(Value{});
+}
+
+template<typename Result, typename Visitor, typename Values>
+struct enum_visit_table;
+
+// One entry per enum value, indexed by the index of the value in the enum
+template<typename Result, typename Visitor, typename... Values>
+struct enum_visit_table<Result, Visitor, tinyrefl::meta::list<Values...>>
+{
+    using function = Result (*)(Visitor&);
+
+    static constexpr function functions[] = {
+        &visit_enum_value<Result, Values, Visitor>...};
+};
+
+template<typename Result, typename Visitor, typename... Values>
+constexpr typename enum_visit_table<
+    Result,
+    Visitor,
+    tinyrefl::meta::list<Values...>>::function
+    enum_visit_table<Result, Visitor, tinyrefl::meta::list<Values...>>::
+        functions[];
+
+template<typename Result, typename Enum, typename Visitor, typename Invalid>
+Result visit_enum_impl(
+    std::true_type /* chain */,
+    const Enum value,
+    Visitor&   visitor,
+    Invalid&   invalid)
+{
+    return enum_visit_chain<Result, typename tinyrefl::metadata<Enum>::values>::
+        visit(value, visitor, invalid);
+}
+
+// The index lookup is a direct indexed table for dense enums, and a binary
+// search for sparse ones (See backend::enum_value_index)
+template<typename Result, typename Enum, typename Visitor, typename Invalid>
+Result visit_enum_impl(
+    std::false_type /* chain */,
+    const Enum value,
+    Visitor&   visitor,
+    Invalid&   invalid)
+{
+    using table = enum_visit_table<
+        Result,
+        Visitor,
+        typename tinyrefl::metadata<Enum>::values>;
+
+    const std::size_t index = tinyrefl::metadata<Enum>().index_of(value);
+
+    if(index < tinyrefl::metadata<Enum>().count())
+    {
+        return table::functions[index](visitor);
+    }
+    else
+    {
+        return invalid(value);
+    }
+}
+
+} // namespace detail
+
+// Calls visitor with the enum_value metadata of value (The enumerator is
+// available as the value_static_value member type), or invalid(value) if
+// value is not an enumerated value. The result of empty enums is the result
+// of invalid.
+// Small enums are dispatched with a chain of comparisons, bigger ones with
+// an index lookup plus an indirect call through a table of functions
+template<typename Enum, typename Visitor, typename Invalid>
+auto visit_enum(const Enum value, Visitor visitor, Invalid invalid)
+    -> std::enable_if_t<
+        std::is_enum<Enum>::value && tinyrefl::has_metadata<Enum>(),
+        tinyrefl::detail::enum_visit_result_t<
+            Visitor,
+            typename tinyrefl::metadata<Enum>::values,
+            decltype(invalid(value))>>
+{
+    using values = typename tinyrefl::metadata<Enum>::values;
+    using result = tinyrefl::detail::
+        enum_visit_result_t<Visitor, values, decltype(invalid(value))>;
+
+    return tinyrefl::detail::visit_enum_impl<result>(
+        tinyrefl::meta::bool_<(
+            values::size <= tinyrefl::detail::enum_visit_chain_max_size)>{},
+        value,
+        visitor,
+        invalid);
+}
+
+// Invalid values return a value initialized result, so the result must be
+// void or default constructible. Empty enums return void
+template<typename Enum, typename Visitor>
+auto visit_enum(const Enum value, Visitor visitor) -> std::enable_if_t<
+    std::is_enum<Enum>::value && tinyrefl::has_metadata<Enum>(),
+    tinyrefl::detail::
+        enum_visit_result_t<Visitor, typename tinyrefl::metadata<Enum>::values>>
+{
+    using result = tinyrefl::detail::
+        enum_visit_result_t<Visitor, typename tinyrefl::metadata<Enum>::values>;
+
+    static_assert(
+        std::is_void<result>::value ||
+            (!std::is_reference<result>::value &&
+             std::is_default_constructible<result>::value),
+        "visit_enum(value, visitor) returns a value initialized result for "
+        "values that are not enumerated, which is not possible if the "
+        "visitor returns a reference or a type that is not default "
+        "constructible. Pass a handler for invalid values instead: "
+        "visit_enum(value, visitor, invalid)");
+
+    return visit_enum(
+        value, visitor, [](const Enum) -> result { return result(); });
+}
+
 template<typename Enum>
 constexpr auto to_string(const Enum value) -> std::enable_if_t<
     std::is_enum<Enum>::value && tinyrefl::has_metadata<Enum>(),
@@ -725,8 +1687,9 @@ auto to_json(const Class& object) -> std::enable_if_t<
     auto result = json::object();
 
     visit_member_variables(
-        object, [&result](const std::string& name, const auto& member) {
-            result[name] = to_json(member);
+        object,
+        [&result](const ctti::detail::cstring& name, const auto& member) {
+            result[name.str()] = to_json(member);
         });
 
     return result;
@@ -740,8 +1703,9 @@ auto from_json(const json& json) -> std::enable_if_t<
     Class result;
 
     visit_member_variables(
-        result, [&json](const std::string& name, auto& member) {
-            member = from_json<std::decay_t<decltype(member)>>(json[name]);
+        result, [&json](const ctti::detail::cstring& name, auto& member) {
+            member =
+                from_json<std::decay_t<decltype(member)>>(json[name.str()]);
         });
 
     return result;
@@ -7,13 +7,22 @@
 #include <ctti/detail/meta.hpp>
 #include <ctti/name.hpp>
 #include <ctti/symbol.hpp>
+#include <cstdint>
 #include <initializer_list>
 #include <stdexcept>
+#include <type_traits>
 #include <tinyrefl/utils/typename.hpp>
 
 #define TINYREFL_STATIC_VALUE(...) \
     ::ctti::static_value<decltype(__VA_ARGS__), (__VA_ARGS__)>
 
+// Packs are folded with fold expressions where available, which
+// instantiate less than the constexpr functions and recursive templates
+// used otherwise
+#if defined(__cpp_fold_expressions) && __cpp_fold_expressions >= 201603L
+#define TINYREFL_HAS_FOLD_EXPRESSIONS
+#endif // __cpp_fold_expressions
+
 namespace tinyrefl
 {
 
@@ -30,12 +39,34 @@ using hash_constant = CTTI_STATIC_VALUE(Hash);
 constexpr ctti::detail::cstring default_string_constant =
     "default tinyrefl string constant";
 
-template<typename Hash>
-constexpr ctti::detail::cstring string_constant()
+// A string stored in a string pool, a class with a static constexpr chars()
+// function returning all the strings of the pool. Direct codegen stores all
+// the strings of a generated file in one pool instead of defining a
+// string_constant() specialization per string
+template<typename Pool, std::size_t Offset, std::size_t Length>
+struct pooled_string
+{
+};
+
+template<typename String>
+constexpr ctti::detail::cstring string_value(String*)
 {
     return default_string_constant;
 }
 
+template<typename Pool, std::size_t Offset, std::size_t Length>
+constexpr ctti::detail::cstring
+    string_value(pooled_string<Pool, Offset, Length>*)
+{
+    return {Pool::chars().begin() + Offset, Length};
+}
+
+template<typename String>
+constexpr ctti::detail::cstring string_constant()
+{
+    return string_value(static_cast<String*>(nullptr));
+}
+
 struct no_metadata
 {
 };
@@ -179,6 +210,33 @@ constexpr
     typename typelist_to_array<tinyrefl::meta::list<Values...>>::array_type
         typelist_to_array<tinyrefl::meta::list<Values...>>::value;
 
+// Static array with one element per type of a list, plus a sentinel
+// element at the end so tables of empty lists are not zero sized arrays.
+// Element has the functions that make the elements:
+//
+//     template<typename U>
+//     static constexpr T element();
+//     static constexpr T sentinel();
+template<typename T, typename Element, typename List>
+struct static_table;
+
+template<typename T, typename Element, typename... Ts>
+struct static_table<T, Element, tinyrefl::meta::list<Ts...>>
+{
+    using array_type = T[sizeof...(Ts) + 1];
+
+    static constexpr std::size_t count = sizeof...(Ts);
+    static constexpr array_type  values = {
+        Element::template element<Ts>()..., Element::sentinel()};
+};
+
+template<typename T, typename Element, typename... Ts>
+constexpr std::size_t
+    static_table<T, Element, tinyrefl::meta::list<Ts...>>::count;
+template<typename T, typename Element, typename... Ts>
+constexpr typename static_table<T, Element, tinyrefl::meta::list<Ts...>>::
+    array_type static_table<T, Element, tinyrefl::meta::list<Ts...>>::values;
+
 template<typename T>
 struct array_view
 {
@@ -393,31 +451,74 @@ constexpr const T* find(const constexpr_array<T, N>& array, const U& value)
     return find(make_array_view(array), value);
 }
 
+struct attribute_name_hash
+{
+    template<typename Attribute>
+    static constexpr ctti::detail::hash_t element()
+    {
+        return Attribute::name.full_name().hash();
+    }
+
+    static constexpr ctti::detail::hash_t sentinel()
+    {
+        return 0;
+    }
+};
+
+// Hashes of the full names of a list of attributes, shared by all the
+// entities with the same attribute list
+template<typename Attributes>
+using attribute_name_hashes =
+    static_table<ctti::detail::hash_t, attribute_name_hash, Attributes>;
+
+// Compares attribute names only if their hashes match
+constexpr const attribute* find_attribute(
+    const array_view<attribute>& attributes,
+    const ctti::detail::hash_t*  hashes,
+    const ctti::detail::cstring& name)
+{
+    const ctti::detail::hash_t hash = name.hash();
+
+    for(std::size_t i = 0; i < attributes.size(); ++i)
+    {
+        if(hashes[i] == hash && attributes[i] == name)
+        {
+            return attributes.begin() + i;
+        }
+    }
+
+    return attributes.end();
+}
+
 template<typename Metadata>
-constexpr const attribute*
-    find_attribute(const Metadata&, const ctti::detail::cstring& attribute)
+constexpr const attribute* find_attribute(
+    const Metadata& metadata, const ctti::detail::cstring& attribute)
 {
-    return find(Metadata::attributes, attribute);
+    return find_attribute(
+        metadata.get_attributes(), Metadata::get_attribute_hashes(), attribute);
 }
 
 template<typename Metadata>
 constexpr bool has_attribute(
     const Metadata& metadata, const ctti::detail::cstring& attribute)
 {
-    return find_attribute(metadata, attribute) != Metadata::attributes.end();
+    return find_attribute(metadata, attribute) !=
+           metadata.get_attributes().end();
 }
 
 template<typename Attributes>
 using attributes_plus_dummy =
     ctti::meta::append_t<Attributes, dummy_attribute_metadata>;
 
+// Entities with the same attribute list share the same attributes array
 template<typename Attributes>
 struct metadata_with_attributes
 {
-    static constexpr decltype(
-        typelist_to_array<attributes_plus_dummy<Attributes>>::value)
-        attributes =
-            typelist_to_array<attributes_plus_dummy<Attributes>>::value;
+    using attributes_array = decltype(
+        typelist_to_array<attributes_plus_dummy<Attributes>>::value);
+
+    static constexpr const attributes_array& attributes =
+        typelist_to_array<attributes_plus_dummy<Attributes>>::value;
 
     constexpr bool has_attribute(const ctti::detail::cstring& name) const
     {
@@ -439,10 +540,15 @@ struct metadata_with_attributes
     {
         return array_view<attribute>{attributes}.trim(1);
     }
+
+    static constexpr const ctti::detail::hash_t* get_attribute_hashes()
+    {
+        return attribute_name_hashes<Attributes>::values;
+    }
 };
 
 template<typename Attributes>
-constexpr decltype(typelist_to_array<attributes_plus_dummy<Attributes>>::value)
+constexpr const typename metadata_with_attributes<Attributes>::attributes_array&
     metadata_with_attributes<Attributes>::attributes;
 
 using dummy_metadata_with_attributes =
@@ -498,6 +604,88 @@ struct member : public Pointer, public metadata_with_attributes<Attributes>
 template<typename Name, typename Pointer, typename Attributes>
 constexpr ctti::name_t member<Name, Pointer, Attributes>::name;
 
+struct member_name_hash
+{
+    template<typename Member>
+    static constexpr ctti::detail::hash_t element()
+    {
+        return Member::name.name().hash();
+    }
+
+    static constexpr ctti::detail::hash_t sentinel()
+    {
+        return 0;
+    }
+};
+
+struct member_name
+{
+    template<typename Member>
+    static constexpr ctti::detail::cstring element()
+    {
+        return Member::name.name();
+    }
+
+    static constexpr ctti::detail::cstring sentinel()
+    {
+        return "";
+    }
+};
+
+// Hashes and names of the (Unqualified) names of a list of members, to look
+// members up by name
+template<typename Members>
+struct member_names
+{
+    using hash_table =
+        static_table<ctti::detail::hash_t, member_name_hash, Members>;
+    using name_table =
+        static_table<ctti::detail::cstring, member_name, Members>;
+
+    static constexpr std::size_t count = hash_table::count;
+};
+
+template<typename Members>
+constexpr std::size_t member_names<Members>::count;
+
+// Index of the member with the given name hash in a list of members, the
+// number of members if there's no member with that name
+template<typename Members>
+constexpr std::size_t member_index(const ctti::detail::hash_t hash)
+{
+    using names = member_names<Members>;
+
+    for(std::size_t i = 0; i < names::count; ++i)
+    {
+        if(names::hash_table::values[i] == hash)
+        {
+            return i;
+        }
+    }
+
+    return names::count;
+}
+
+// Compares member names only if their hashes match
+template<typename Members>
+constexpr std::size_t member_index(const ctti::detail::cstring& name)
+{
+    using names = member_names<Members>;
+
+    const ctti::detail::hash_t hash = name.hash();
+
+    for(std::size_t i = 0; i < names::count; ++i)
+    {
+        if(names::hash_table::values[i] == hash &&
+           names::name_table::values[i] == name)
+        {
+            return i;
+        }
+    }
+
+    return names::count;
+}
+
 template<
     typename Name,
     typename DisplayName,
@@ -639,6 +827,87 @@ template<typename Name, typename Class, typename... Args, typename Attributes>
 constexpr ctti::detail::cstring
     constructor<Name, Class, tinyrefl::meta::list<Args...>, Attributes>::name;
 
+constexpr std::size_t sum_of(std::initializer_list<std::size_t> values)
+{
+    std::size_t result = 0;
+
+    for(const std::size_t value : values)
+    {
+        result += value;
+    }
+
+    return result;
+}
+
+constexpr bool all_of(std::initializer_list<bool> values)
+{
+    for(const bool value : values)
+    {
+        if(!value)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Members and member variables contributed by a base class to the totals of
+// its derived classes, none if the base class is not reflected
+template<
+    typename BaseClass,
+    bool = metadata_registered_for_type<BaseClass>::value>
+struct base_class_members
+{
+    static constexpr std::size_t total = 0;
+    using member_variables             = tinyrefl::meta::list<>;
+};
+
+template<typename BaseClass>
+struct base_class_members<BaseClass, true>
+{
+    static constexpr std::size_t total =
+        metadata_of_type<BaseClass>::members::size +
+        metadata_of_type<BaseClass>::total_members::value;
+    using member_variables =
+        typename metadata_of_type<BaseClass>::all_member_variables;
+};
+
+template<typename BaseClass, bool IsReflected>
+constexpr std::size_t base_class_members<BaseClass, IsReflected>::total;
+template<typename BaseClass>
+constexpr std::size_t base_class_members<BaseClass, true>::total;
+
+#ifdef TINYREFL_HAS_FOLD_EXPRESSIONS
+// Concatenates typelists in a fold expression, see base_classes_members
+template<typename... Lhs, typename... Rhs>
+tinyrefl::meta::list<Lhs..., Rhs...>
+    operator+(tinyrefl::meta::list<Lhs...>, tinyrefl::meta::list<Rhs...>);
+#endif // TINYREFL_HAS_FOLD_EXPRESSIONS
+
+template<typename BaseClasses>
+struct base_classes_members;
+
+template<typename... BaseClasses>
+struct base_classes_members<tinyrefl::meta::list<BaseClasses...>>
+{
+#ifdef TINYREFL_HAS_FOLD_EXPRESSIONS
+    using total = tinyrefl::meta::size_t<(
+        std::size_t{0} + ... + base_class_members<BaseClasses>::total)>;
+    using member_variables = decltype(
+        (tinyrefl::meta::list<>{} + ... +
+         typename base_class_members<BaseClasses>::member_variables{}));
+#else
+    using total = tinyrefl::meta::size_t<sum_of(
+        {base_class_members<BaseClasses>::total..., 0})>;
+    using member_variables = tinyrefl::meta::foldl_t<
+        tinyrefl::meta::defer<tinyrefl::meta::cat>,
+        tinyrefl::meta::list<>,
+        tinyrefl::meta::list<
+            typename base_class_members<BaseClasses>::member_variables...>>;
+#endif // TINYREFL_HAS_FOLD_EXPRESSIONS
+};
+
 template<
     typename Name,
     typename Class,
@@ -677,32 +946,18 @@ public:
 
     constexpr class_() = default;
 
-private:
-    template<
-        typename Total,
-        typename BaseClass,
-        typename HasMetadata = tinyrefl::meta::bool_<
-            metadata_registered_for_type<BaseClass>::value>>
-    struct accumulate
-    {
-        using type = Total;
-    };
-
-    template<typename Total, typename BaseClass>
-    struct accumulate<Total, BaseClass, std::true_type>
-    {
-        using type = tinyrefl::meta::size_t<
-            Total::value + metadata_of_type<BaseClass>::members::size +
-            metadata_of_type<BaseClass>::total_members::value>;
-    };
-
-public:
-    using total_base_members = tinyrefl::meta::foldl_t<
-        tinyrefl::meta::defer<accumulate>,
-        tinyrefl::meta::size_t<0>,
-        base_classes>;
+    using total_base_members =
+        typename base_classes_members<base_classes>::total;
     using total_members =
         tinyrefl::meta::size_t<members::size + total_base_members::value>;
+
+    // Member variables of the class and its reflected base classes (Base
+    // classes first, in declaration order), flattened so they can be visited
+    // with no recursion. Member pointers of base classes can be applied to
+    // Class objects directly
+    using all_member_variables = tinyrefl::meta::cat_t<
+        typename base_classes_members<base_classes>::member_variables,
+        member_variables>;
 };
 
 template<
@@ -802,171 +1057,814 @@ struct enum_value : public Value, public metadata_with_attributes<Attributes>
 template<typename Name, typename Value, typename Attributes>
 constexpr ctti::name_t enum_value<Name, Value, Attributes>::name;
 
-template<
-    typename Name,
-    typename Enum,
-    typename Values,
-    typename Attributes = tinyrefl::meta::list<>>
-struct enum_;
+constexpr std::size_t
+    next_power_of_two(const std::size_t n, const std::size_t p = 1)
+{
+    return p >= n ? p : next_power_of_two(n, p * 2);
+}
 
-template<typename Name, typename Enum, typename... Values, typename Attributes>
-struct enum_<Name, Enum, tinyrefl::meta::list<Values...>, Attributes>
-    : public metadata_with_attributes<Attributes>
+constexpr char to_lower(const char c)
 {
-    static constexpr entity_kind  kind = entity_kind::ENUM;
-    static constexpr ctti::name_t name =
-        tinyrefl::backend::string_constant<Name>();
-    using values          = tinyrefl::meta::list<Values...>;
-    using enum_type       = Enum;
-    using underlying_type = typename std::underlying_type<enum_type>::type;
+    return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+}
 
-    struct value_t
+// FNV-1a, same as ctti::detail::cstring::hash() when case sensitive
+constexpr ctti::detail::hash_t
+    name_hash(const ctti::detail::cstring& name, const bool case_insensitive)
+{
+    ctti::detail::hash_t hash = 14695981039346656037ull;
+
+    for(std::size_t i = 0; i < name.size(); ++i)
     {
-        template<typename EnumValueMetadata>
-        constexpr value_t(const EnumValueMetadata& enum_value)
-            : value_t{enum_value.value(),
-                      enum_value.value_name(),
-                      enum_value.get_attributes()}
-        {
-        }
+        hash ^= static_cast<ctti::detail::hash_t>(
+            case_insensitive ? to_lower(name[i]) : name[i]);
+        hash *= 1099511628211ull;
+    }
 
-        constexpr value_t(
-            const enum_type              value,
-            const ctti::detail::cstring& name,
-            const array_view<attribute>& attributes)
-            : _value{value}, _name{name}, _attributes{attributes}
-        {
-        }
+    return hash;
+}
 
-        constexpr ctti::detail::cstring name() const
-        {
-            return _name;
-        }
+constexpr bool names_equal(
+    const ctti::detail::cstring& lhs,
+    const ctti::detail::cstring& rhs,
+    const bool                   case_insensitive)
+{
+    if(lhs.size() != rhs.size())
+    {
+        return false;
+    }
 
-        constexpr enum_type value() const
+    for(std::size_t i = 0; i < lhs.size(); ++i)
+    {
+        if(case_insensitive ? to_lower(lhs[i]) != to_lower(rhs[i])
+                            : lhs[i] != rhs[i])
         {
-            return _value;
+            return false;
         }
+    }
 
-        constexpr underlying_type underlying_value() const
-        {
-            return static_cast<underlying_type>(value());
-        }
+    return true;
+}
 
-        constexpr bool has_attribute(const ctti::detail::cstring& name) const
-        {
-            return tinyrefl::backend::find(_attributes, name) !=
-                   _attributes.end();
-        }
+// Compile time open addressing hash table (With linear probing) indexing a
+// sequence of named elements by name. Slots must be a power of two greater
+// than the number of elements
+template<std::size_t Slots>
+struct name_index
+{
+    static_assert(
+        Slots > 0 && (Slots & (Slots - 1)) == 0,
+        "name_index slots must be a power of two");
 
-        constexpr const attribute&
-            get_attribute(const ctti::detail::cstring& name) const
+    template<typename Elements>
+    constexpr name_index(const Elements& elements, const bool case_insensitive)
+        : _case_insensitive{case_insensitive}, _hashes{}, _indices{}
+    {
+        for(std::size_t i = 0; i < elements.size(); ++i)
         {
-            return *tinyrefl::backend::find(_attributes, name);
+            const auto  hash = name_hash(elements[i].name(), case_insensitive);
+            std::size_t slot = hash & (Slots - 1);
+
+            while(_indices[slot] != 0 &&
+                  !names_equal(
+                      elements[_indices[slot] - 1].name(),
+                      elements[i].name(),
+                      case_insensitive))
+            {
+                slot = (slot + 1) & (Slots - 1);
+            }
+
+            // Keep the first element if names clash
+            if(_indices[slot] == 0)
+            {
+                _hashes[slot]  = hash;
+                _indices[slot] = i + 1;
+            }
         }
+    }
 
-        constexpr operator enum_type() const
+    // Returns the index of the element with the given name, -1 if not found
+    template<typename Elements>
+    constexpr int find(
+        const Elements& elements, const ctti::detail::cstring& name) const
+    {
+        const auto  hash = name_hash(name, _case_insensitive);
+        std::size_t slot = hash & (Slots - 1);
+
+        for(; _indices[slot] != 0; slot = (slot + 1) & (Slots - 1))
         {
-            return value();
+            if(_hashes[slot] == hash &&
+               names_equal(
+                   elements[_indices[slot] - 1].name(),
+                   name,
+                   _case_insensitive))
+            {
+                return static_cast<int>(_indices[slot] - 1);
+            }
         }
 
-        friend constexpr bool
-            operator==(const value_t& lhs, const ctti::detail::cstring& name)
+        return -1;
+    }
+
+private:
+    bool                 _case_insensitive;
+    ctti::detail::hash_t _hashes[Slots];
+    std::size_t          _indices[Slots]; // Element index + 1, 0 if empty
+};
+
+// Name index of the values of an enum_, built on first use
+template<typename Enum, bool CaseInsensitive>
+struct enum_name_index
+{
+    using type = name_index<next_power_of_two(2 * Enum::values::size)>;
+
+    static constexpr type value = type{Enum::enum_values, CaseInsensitive};
+};
+
+template<typename Enum, bool CaseInsensitive>
+constexpr typename enum_name_index<Enum, CaseInsensitive>::type
+    enum_name_index<Enum, CaseInsensitive>::value;
+
+template<typename Underlying, typename Elements>
+constexpr Underlying min_underlying_value(const Elements& elements)
+{
+    Underlying result = elements.size() > 0 ? elements[0].underlying_value()
+                                            : Underlying{};
+
+    for(std::size_t i = 1; i < elements.size(); ++i)
+    {
+        if(elements[i].underlying_value() < result)
         {
-            return lhs.value_name() == name;
+            result = elements[i].underlying_value();
         }
+    }
 
-        friend constexpr bool
-            operator==(const value_t& lhs, const enum_type value)
+    return result;
+}
+
+template<typename Underlying, typename Elements>
+constexpr Underlying max_underlying_value(const Elements& elements)
+{
+    Underlying result = elements.size() > 0 ? elements[0].underlying_value()
+                                            : Underlying{};
+
+    for(std::size_t i = 1; i < elements.size(); ++i)
+    {
+        if(result < elements[i].underlying_value())
         {
-            return lhs.value() == value;
+            result = elements[i].underlying_value();
         }
+    }
 
-        friend constexpr bool
-            operator==(const value_t& lhs, const underlying_type value)
+    return result;
+}
+
+// Distance from min to value, computed in std::uintmax_t since the
+// difference may not fit in the (signed) underlying type
+template<typename Underlying>
+constexpr std::uintmax_t
+    value_offset(const Underlying min, const Underlying value)
+{
+    return static_cast<std::uintmax_t>(value) -
+           static_cast<std::uintmax_t>(min);
+}
+
+// Table with the index of each value in [Min, Min + Size), -1 for values
+// that are not enumerated
+template<typename Underlying, std::size_t Size>
+struct value_offset_index
+{
+    template<typename Elements>
+    constexpr value_offset_index(const Elements& elements)
+        : _min{min_underlying_value<Underlying>(elements)}, _indices{}
+    {
+        for(std::size_t i = 0; i < Size; ++i)
         {
-            return lhs.underlying_value() == value;
+            _indices[i] = -1;
         }
 
-        friend constexpr bool
-            operator!=(const value_t& lhs, const ctti::detail::cstring& name)
+        // Keep the first element if values clash
+        for(std::size_t i = elements.size(); i > 0; --i)
         {
-            return !(lhs == name);
+            _indices[value_offset(_min, elements[i - 1].underlying_value())] =
+                static_cast<int>(i - 1);
         }
+    }
 
-        friend constexpr bool
-            operator!=(const value_t& lhs, const enum_type value)
+    // Returns the index of the element with the given value, -1 if not found
+    constexpr int find(const Underlying value) const
+    {
+        return value_offset(_min, value) < Size
+                   ? _indices[value_offset(_min, value)]
+                   : -1;
+    }
+
+private:
+    Underlying _min;
+    int        _indices[Size];
+};
+
+// Table of values sorted for binary search, for enums with values too
+// sparse to be direct indexed
+template<typename Underlying, std::size_t Size>
+struct value_sorted_index
+{
+    template<typename Elements>
+    constexpr value_sorted_index(const Elements& elements)
+        : _values{}, _indices{}
+    {
+        for(std::size_t i = 0; i < Size; ++i)
         {
-            return !(lhs == value);
+            _values[i]  = elements[i].underlying_value();
+            _indices[i] = static_cast<int>(i);
         }
 
-        friend constexpr bool
-            operator!=(const value_t& lhs, const underlying_type value)
+        // Heapsort, keeps the number of constexpr evaluation steps low
+        // for big enums
+        for(std::size_t i = Size / 2; i > 0; --i)
         {
-            return !(lhs == value);
+            sift_down(i - 1, Size);
         }
 
-        inline friend std::ostream&
-            operator<<(std::ostream& os, const value_t value)
+        for(std::size_t end = Size; end > 1; --end)
         {
-            return os << value.name();
+            swap(0, end - 1);
+            sift_down(0, end - 1);
         }
+    }
 
-    private:
-        enum_type             _value;
-        ctti::detail::cstring _name;
-        array_view<attribute> _attributes;
-    };
-
-    using values_array = std::array<value_t, values::size>;
-    static constexpr values_array enum_values = {{value_t{Values{}}...}};
-    static constexpr value_t      invalid_value =
-        value_t{enum_type{},
-                "invalid enum value",
-                dummy_metadata_with_attributes{}.get_attributes()};
+    // Returns the index of the element with the given value, -1 if not found
+    constexpr int find(const Underlying value) const
+    {
+        std::size_t begin = 0;
+        std::size_t end   = Size;
 
-    constexpr enum_() = default;
+        while(begin < end)
+        {
+            const std::size_t middle = begin + (end - begin) / 2;
+
+            if(_values[middle] < value)
+            {
+                begin = middle + 1;
+            }
+            else
+            {
+                end = middle;
+            }
+        }
 
-    constexpr std::size_t count() const
-    {
-        return values::size;
+        return (begin < Size && _values[begin] == value) ? _indices[begin]
+                                                         : -1;
     }
 
-    constexpr const ctti::name_t& name_() const
+    constexpr const Underlying* values() const
     {
-        return enum_::name;
+        return _values;
     }
 
-    constexpr const value_t& get_value(const ctti::detail::cstring& name) const
+    constexpr std::size_t size() const
     {
-        return get_values()[find_value_index(name)];
+        return Size;
     }
 
-    constexpr const value_t& get_value(const std::size_t i) const
-    {
-        return get_values()[i];
-    }
+private:
+    Underlying _values[Size];
+    int        _indices[Size];
 
-    constexpr const value_t& get_value(const enum_type value) const
+    // Equal values are ordered by index, so the first of them is found
+    constexpr bool less(const std::size_t i, const std::size_t j) const
     {
-        return get_values()[find_value_index(value)];
+        return _values[i] < _values[j] ||
+               (_values[i] == _values[j] && _indices[i] < _indices[j]);
     }
 
-    constexpr const value_t& get_value(const underlying_type value) const
+    constexpr void swap(const std::size_t i, const std::size_t j)
     {
-        return get_value(static_cast<enum_type>(value));
+        const Underlying value = _values[i];
+        const int        index = _indices[i];
+        _values[i]             = _values[j];
+        _indices[i]            = _indices[j];
+        _values[j]             = value;
+        _indices[j]            = index;
     }
 
-    constexpr bool is_enumerated_value(const underlying_type value) const
+    constexpr void sift_down(std::size_t root, const std::size_t end)
+    {
+        std::size_t child = 2 * root + 1;
+
+        while(child < end)
+        {
+            if(child + 1 < end && less(child, child + 1))
+            {
+                ++child;
+            }
+
+            if(!less(root, child))
+            {
+                return;
+            }
+
+            swap(root, child);
+            root  = child;
+            child = 2 * root + 1;
+        }
+    }
+};
+
+// Value index of an enum_, built on first use. Enums whose values span up
+// to twice the number of values are direct indexed
+template<typename Enum>
+struct enum_value_index
+{
+    using underlying_type = typename Enum::underlying_type;
+
+    static constexpr std::size_t count = Enum::values::size;
+    static constexpr std::uintmax_t span =
+        count > 0
+            ? value_offset(
+                  min_underlying_value<underlying_type>(Enum::enum_values),
+                  max_underlying_value<underlying_type>(Enum::enum_values)) +
+                  1
+            : 1;
+    static constexpr bool dense = span != 0 && span <= 2 * count;
+
+    using type = typename std::conditional<
+        dense,
+        value_offset_index<underlying_type, (dense ? span : 1)>,
+        value_sorted_index<underlying_type, (dense ? 1 : count)>>::type;
+
+    static constexpr type value = type{Enum::enum_values};
+};
+
+template<typename Enum>
+constexpr std::size_t enum_value_index<Enum>::count;
+template<typename Enum>
+constexpr std::uintmax_t enum_value_index<Enum>::span;
+template<typename Enum>
+constexpr bool enum_value_index<Enum>::dense;
+template<typename Enum>
+constexpr typename enum_value_index<Enum>::type enum_value_index<Enum>::value;
+
+// Bitmap of the values in [min, min + Bits)
+template<typename Underlying, std::size_t Bits>
+struct value_bitmap
+{
+    template<typename Elements>
+    constexpr value_bitmap(const Elements& elements)
+        : _min{min_underlying_value<Underlying>(elements)}, _words{}
+    {
+        for(std::size_t i = 0; i < elements.size(); ++i)
+        {
+            const auto offset =
+                value_offset(_min, elements[i].underlying_value());
+            _words[offset / 64] |= std::uint64_t{1} << (offset % 64);
+        }
+    }
+
+    constexpr bool contains(const Underlying value) const
+    {
+        return value_offset(_min, value) < Bits &&
+               ((_words[value_offset(_min, value) / 64] >>
+                 (value_offset(_min, value) % 64)) &
+                1) != 0;
+    }
+
+private:
+    Underlying    _min;
+    std::uint64_t _words[(Bits + 63) / 64];
+};
+
+// Set of the values of an enum_, for bulk validation of raw values. Small
+// value domains are checked against a bitmap of the domain, sparse enums
+// against their sorted values
+template<
+    typename Enum,
+    bool Bitmap = (enum_value_index<Enum>::span != 0 &&
+                   enum_value_index<Enum>::span <= 4096)>
+struct enum_value_domain;
+
+template<typename Enum>
+struct enum_value_domain<Enum, true>
+{
+    using underlying_type = typename Enum::underlying_type;
+    using bitmap_type =
+        value_bitmap<underlying_type, enum_value_index<Enum>::span>;
+
+    static constexpr bitmap_type bitmap = bitmap_type{Enum::enum_values};
+
+    static constexpr bool contains(const underlying_type value)
+    {
+        return bitmap.contains(value);
+    }
+};
+
+template<typename Enum>
+constexpr typename enum_value_domain<Enum, true>::bitmap_type
+    enum_value_domain<Enum, true>::bitmap;
+
+template<typename Enum>
+struct enum_value_domain<Enum, false>
+{
+    using underlying_type = typename Enum::underlying_type;
+    using sorted_type = value_sorted_index<underlying_type, Enum::values::size>;
+
+    static constexpr sorted_type sorted = sorted_type{Enum::enum_values};
+
+    // Few values are compared all at once, without branches, so the
+    // compiler can vectorize the comparisons
+    static constexpr std::size_t max_compared_values = 16;
+
+    static constexpr bool contains(const underlying_type value)
+    {
+        if(sorted.size() > max_compared_values)
+        {
+            return sorted.find(value) >= 0;
+        }
+
+        bool found = false;
+
+        for(std::size_t i = 0; i < sorted.size(); ++i)
+        {
+            found |= sorted.values()[i] == value;
+        }
+
+        return found;
+    }
+};
+
+template<typename Enum>
+constexpr typename enum_value_domain<Enum, false>::sorted_type
+    enum_value_domain<Enum, false>::sorted;
+template<typename Enum>
+constexpr std::size_t enum_value_domain<Enum, false>::max_compared_values;
+
+// Returns the index of the first value not in the domain of the enum, or
+// values.size() if all are. Values are checked in blocks without early
+// exit so the checks of a block can be pipelined
+template<typename Enum>
+std::size_t find_non_enumerated_value(
+    const array_view<typename Enum::underlying_type>& values)
+{
+    constexpr std::size_t block_size = 16;
+    const std::size_t     size       = values.size();
+    std::size_t           i          = 0;
+
+    for(; i + block_size <= size; i += block_size)
+    {
+        bool block_valid = true;
+
+        for(std::size_t j = 0; j < block_size; ++j)
+        {
+            block_valid &= enum_value_domain<Enum>::contains(values[i + j]);
+        }
+
+        if(!block_valid)
+        {
+            break;
+        }
+    }
+
+    for(; i < size; ++i)
+    {
+        if(!enum_value_domain<Enum>::contains(values[i]))
+        {
+            return i;
+        }
+    }
+
+    return size;
+}
+
+// Sets bit i % 64 of mask[i / 64] if values[i] is in the domain of the
+// enum, clears it otherwise. Returns the number of values not in the domain
+template<typename Enum>
+std::size_t enumerated_values_mask(
+    const array_view<typename Enum::underlying_type>& values,
+    std::uint64_t*                                    mask)
+{
+    std::size_t non_enumerated = 0;
+
+    for(std::size_t word = 0; word * 64 < values.size(); ++word)
+    {
+        std::uint64_t bits = 0;
+
+        for(std::size_t bit = 0; bit < 64 && word * 64 + bit < values.size();
+            ++bit)
+        {
+            const bool valid =
+                enum_value_domain<Enum>::contains(values[word * 64 + bit]);
+            bits |= std::uint64_t{valid} << bit;
+            non_enumerated += !valid;
+        }
+
+        mask[word] = bits;
+    }
+
+    return non_enumerated;
+}
+
+template<typename... Names>
+constexpr std::size_t names_blob_size(const Names&... names)
+{
+    const ctti::detail::cstring strings[] = {names...};
+    std::size_t                 size      = 0;
+
+    for(const auto& string : strings)
+    {
+        size += string.size() + 1;
+    }
+
+    return size;
+}
+
+// A sequence of names stored in one character array, each one null
+// terminated, plus the table of offsets of each name in the array. The
+// names are copied during constant evaluation only, so the blob is the one
+// copy of the names emitted
+template<std::size_t Count, std::size_t Size>
+struct names_blob
+{
+    template<typename... Names>
+    constexpr names_blob(const Names&... strings) : _chars{}, _offsets{}
+    {
+        static_assert(sizeof...(Names) == Count, "Wrong number of names");
+
+        const ctti::detail::cstring names[] = {strings...};
+        std::size_t                 offset  = 0;
+
+        for(std::size_t i = 0; i < Count; ++i)
+        {
+            _offsets[i] = static_cast<std::uint32_t>(offset);
+
+            for(std::size_t j = 0; j < names[i].size(); ++j)
+            {
+                _chars[offset++] = names[i][j];
+            }
+
+            _chars[offset++] = '\0';
+        }
+
+        _offsets[Count] = static_cast<std::uint32_t>(offset);
+    }
+
+    constexpr ctti::detail::cstring operator[](const std::size_t i) const
+    {
+        return {_chars + _offsets[i], _offsets[i + 1] - _offsets[i] - 1};
+    }
+
+    constexpr std::size_t size() const
+    {
+        return Count;
+    }
+
+private:
+    char          _chars[Size > 0 ? Size : 1];
+    std::uint32_t _offsets[Count + 1];
+};
+
+template<typename Value, typename Values, typename Indices>
+struct make_enum_values;
+
+// Builds the array of values of an enum_, each value referencing its
+// name and attributes by index
+template<typename Value, typename... Values, std::size_t... Indices>
+struct make_enum_values<
+    Value,
+    tinyrefl::meta::list<Values...>,
+    tinyrefl::meta::index_sequence<Indices...>>
+{
+    using type = std::array<Value, sizeof...(Values)>;
+
+    static constexpr type value = {{Value{Values{}.value(), Indices}...}};
+};
+
+template<typename Value, typename... Values, std::size_t... Indices>
+constexpr typename make_enum_values<
+    Value,
+    tinyrefl::meta::list<Values...>,
+    tinyrefl::meta::index_sequence<Indices...>>::type
+    make_enum_values<
+        Value,
+        tinyrefl::meta::list<Values...>,
+        tinyrefl::meta::index_sequence<Indices...>>::value;
+
+template<
+    typename Name,
+    typename Enum,
+    typename Values,
+    typename Attributes = tinyrefl::meta::list<>>
+struct enum_;
+
+template<typename Name, typename Enum, typename... Values, typename Attributes>
+struct enum_<Name, Enum, tinyrefl::meta::list<Values...>, Attributes>
+    : public metadata_with_attributes<Attributes>
+{
+    static constexpr entity_kind  kind = entity_kind::ENUM;
+    static constexpr ctti::name_t name =
+        tinyrefl::backend::string_constant<Name>();
+    using values          = tinyrefl::meta::list<Values...>;
+    using enum_type       = Enum;
+    using underlying_type = typename std::underlying_type<enum_type>::type;
+
+    // Values only store the enumerator value and the index of the value in
+    // the enum, names and attributes are stored apart in enum_::value_names
+    // and enum_::value_attributes. Index count() is the invalid value
+    struct value_t
+    {
+        constexpr value_t(const enum_type value, const std::size_t index)
+            : _value{value}, _index{static_cast<std::uint32_t>(index)}
+        {
+        }
+
+        constexpr ctti::detail::cstring name() const
+        {
+            return value_names[_index];
+        }
+
+        constexpr enum_type value() const
+        {
+            return _value;
+        }
+
+        constexpr underlying_type underlying_value() const
+        {
+            return static_cast<underlying_type>(value());
+        }
+
+        constexpr std::size_t index() const
+        {
+            return _index;
+        }
+
+        constexpr array_view<attribute> get_attributes() const
+        {
+            return value_attributes[_index];
+        }
+
+        constexpr bool has_attribute(const ctti::detail::cstring& name) const
+        {
+            return find_attribute(name) != get_attributes().end();
+        }
+
+        constexpr const attribute&
+            get_attribute(const ctti::detail::cstring& name) const
+        {
+            return *find_attribute(name);
+        }
+
+        constexpr operator enum_type() const
+        {
+            return value();
+        }
+
+        friend constexpr bool
+            operator==(const value_t& lhs, const ctti::detail::cstring& name)
+        {
+            return lhs.name() == name;
+        }
+
+        friend constexpr bool
+            operator==(const value_t& lhs, const enum_type value)
+        {
+            return lhs.value() == value;
+        }
+
+        friend constexpr bool
+            operator==(const value_t& lhs, const underlying_type value)
+        {
+            return lhs.underlying_value() == value;
+        }
+
+        friend constexpr bool
+            operator!=(const value_t& lhs, const ctti::detail::cstring& name)
+        {
+            return !(lhs == name);
+        }
+
+        friend constexpr bool
+            operator!=(const value_t& lhs, const enum_type value)
+        {
+            return !(lhs == value);
+        }
+
+        friend constexpr bool
+            operator!=(const value_t& lhs, const underlying_type value)
+        {
+            return !(lhs == value);
+        }
+
+        inline friend std::ostream&
+            operator<<(std::ostream& os, const value_t value)
+        {
+            return os << value.name();
+        }
+
+    private:
+        enum_type     _value;
+        std::uint32_t _index;
+
+        constexpr const attribute*
+            find_attribute(const ctti::detail::cstring& name) const
+        {
+            return tinyrefl::backend::find_attribute(
+                get_attributes(), value_attribute_hashes[_index], name);
+        }
+    };
+
+    using value_names_blob = names_blob<
+        values::size + 1,
+        names_blob_size(
+            Values{}.value_name()...,
+            ctti::detail::cstring{"invalid enum value"})>;
+    static constexpr value_names_blob value_names{
+        Values{}.value_name()...,
+        ctti::detail::cstring{"invalid enum value"}};
+
+    using attributes_array =
+        std::array<array_view<attribute>, values::size + 1>;
+    static constexpr attributes_array value_attributes = {
+        {Values{}.get_attributes()...,
+         dummy_metadata_with_attributes{}.get_attributes()}};
+
+    using attribute_hashes_array =
+        std::array<const ctti::detail::hash_t*, values::size + 1>;
+    static constexpr attribute_hashes_array value_attribute_hashes = {
+        {Values::get_attribute_hashes()...,
+         dummy_metadata_with_attributes::get_attribute_hashes()}};
+
+    using values_array = std::array<value_t, values::size>;
+    static constexpr values_array enum_values = make_enum_values<
+        value_t,
+        values,
+        tinyrefl::meta::make_index_sequence<values::size>>::value;
+    static constexpr value_t invalid_value = value_t{enum_type{}, values::size};
+
+    constexpr enum_() = default;
+
+    constexpr std::size_t count() const
+    {
+        return values::size;
+    }
+
+    constexpr const ctti::name_t& name_() const
+    {
+        return enum_::name;
+    }
+
+    constexpr const value_t& get_value(const ctti::detail::cstring& name) const
+    {
+        return get_values()[find_value_index(name)];
+    }
+
+    constexpr const value_t& get_value(const std::size_t i) const
+    {
+        return get_values()[i];
+    }
+
+    constexpr const value_t&
+        get_value_case_insensitive(const ctti::detail::cstring& name) const
+    {
+        return get_values()[find_value_index_case_insensitive(name)];
+    }
+
+    constexpr const value_t& get_value(const enum_type value) const
+    {
+        return get_values()[find_value_index(value)];
+    }
+
+    constexpr const value_t& get_value(const underlying_type value) const
+    {
+        return get_value(static_cast<enum_type>(value));
+    }
+
+    constexpr bool is_enumerated_value(const underlying_type value) const
     {
         return find_value_index(value) >= 0;
     }
 
+    // Returns the index of the value in the enum, or count() if value is not
+    // an enumerated value
+    constexpr std::size_t index_of(const enum_type value) const
+    {
+        return index_or_count(find_value_index(value));
+    }
+
+    constexpr std::size_t index_of(const ctti::detail::cstring& name) const
+    {
+        return index_or_count(find_value_index(name));
+    }
+
     constexpr bool is_enumerated_value(const ctti::detail::cstring name) const
     {
         return find_value_index(name) >= 0;
     }
 
+    constexpr bool is_enumerated_value_case_insensitive(
+        const ctti::detail::cstring name) const
+    {
+        return find_value_index_case_insensitive(name) >= 0;
+    }
+
     constexpr const values_array& get_values() const
     {
         return enum_values;
@@ -985,31 +1883,30 @@ struct enum_<Name, Enum, tinyrefl::meta::list<Values...>, Attributes>
     }
 
 private:
-    constexpr int find_value_index(
-        const ctti::detail::cstring& name, std::size_t i = 0) const
+    constexpr std::size_t index_or_count(const int index) const
     {
-        return (i < count()) ? (get_value(i).name() == name
-                                    ? static_cast<int>(i)
-                                    : find_value_index(name, i + 1))
-                             : -1;
+        return index >= 0 ? static_cast<std::size_t>(index) : count();
     }
 
-    constexpr int
-        find_value_index(const underlying_type value, std::size_t i = 0) const
+    constexpr int find_value_index(const ctti::detail::cstring& name) const
     {
-        return (i < count())
-                   ? (get_values()[i] == value ? static_cast<int>(i)
-                                               : find_value_index(value, i + 1))
-                   : -1;
+        return enum_name_index<enum_, false>::value.find(get_values(), name);
     }
 
-    constexpr int
-        find_value_index(const enum_type value, std::size_t i = 0) const
+    constexpr int find_value_index_case_insensitive(
+        const ctti::detail::cstring& name) const
     {
-        return (i < count())
-                   ? (get_values()[i] == value ? static_cast<int>(i)
-                                               : find_value_index(value, i + 1))
-                   : -1;
+        return enum_name_index<enum_, true>::value.find(get_values(), name);
+    }
+
+    constexpr int find_value_index(const underlying_type value) const
+    {
+        return enum_value_index<enum_>::value.find(value);
+    }
+
+    constexpr int find_value_index(const enum_type value) const
+    {
+        return find_value_index(static_cast<underlying_type>(value));
     }
 };
 
@@ -1023,11 +1920,324 @@ template<typename Name, typename Enum, typename... Values, typename Attributes>
 constexpr ctti::name_t
     enum_<Name, Enum, tinyrefl::meta::list<Values...>, Attributes>::name;
 template<typename Name, typename Enum, typename... Values, typename Attributes>
+constexpr
+    typename enum_<Name, Enum, tinyrefl::meta::list<Values...>, Attributes>::
+        value_names_blob
+            enum_<Name, Enum, tinyrefl::meta::list<Values...>, Attributes>::
+                value_names;
+template<typename Name, typename Enum, typename... Values, typename Attributes>
+constexpr
+    typename enum_<Name, Enum, tinyrefl::meta::list<Values...>, Attributes>::
+        attributes_array
+            enum_<Name, Enum, tinyrefl::meta::list<Values...>, Attributes>::
+                value_attributes;
+template<typename Name, typename Enum, typename... Values, typename Attributes>
+constexpr
+    typename enum_<Name, Enum, tinyrefl::meta::list<Values...>, Attributes>::
+        attribute_hashes_array
+            enum_<Name, Enum, tinyrefl::meta::list<Values...>, Attributes>::
+                value_attribute_hashes;
+template<typename Name, typename Enum, typename... Values, typename Attributes>
 constexpr
     typename enum_<Name, Enum, tinyrefl::meta::list<Values...>, Attributes>::
         value_t enum_<Name, Enum, tinyrefl::meta::list<Values...>, Attributes>::
             invalid_value;
 
+// Facets of class and enum metadata (Name, members, attributes, ...), taken
+// from the template arguments of the metadata type. Using a facet does not
+// instantiate the full metadata, so a TU that only needs the name of a type
+// does not pay for its members, base classes and attributes
+template<typename Metadata>
+struct metadata_facets
+{
+};
+
+template<
+    typename Name,
+    typename Class,
+    typename BaseClasses,
+    typename Constructors,
+    typename MemberFunctions,
+    typename MemberVariables,
+    typename Classes,
+    typename Enums,
+    typename Attributes>
+struct metadata_facets<class_<
+    Name,
+    Class,
+    BaseClasses,
+    Constructors,
+    MemberFunctions,
+    MemberVariables,
+    Classes,
+    Enums,
+    Attributes>>
+{
+    static constexpr entity_kind kind = entity_kind::CLASS;
+    using name_type                   = Name;
+    using type                        = Class;
+    using base_classes                = BaseClasses;
+    using constructors                = Constructors;
+    using member_functions            = MemberFunctions;
+    using member_variables            = MemberVariables;
+    using classes                     = Classes;
+    using enums                       = Enums;
+    using attributes = metadata_with_attributes<Attributes>;
+};
+
+template<typename Name, typename Enum, typename Values, typename Attributes>
+struct metadata_facets<enum_<Name, Enum, Values, Attributes>>
+{
+    static constexpr entity_kind kind = entity_kind::ENUM;
+    using name_type                   = Name;
+    using type                        = Enum;
+    using values                      = Values;
+    using attributes = metadata_with_attributes<Attributes>;
+};
+
+template<typename Name, typename Pointer, typename Attributes>
+struct metadata_facets<member<Name, Pointer, Attributes>>
+{
+    using name_type  = Name;
+    using pointer    = Pointer;
+    using attributes = metadata_with_attributes<Attributes>;
+};
+
+template<
+    typename Name,
+    typename DisplayName,
+    typename FullDisplayName,
+    typename Signature,
+    typename ArgNames,
+    typename Pointer,
+    typename Attributes>
+struct metadata_facets<member_function<
+    Name,
+    DisplayName,
+    FullDisplayName,
+    Signature,
+    ArgNames,
+    Pointer,
+    Attributes>>
+{
+    using name_type  = Name;
+    using pointer    = Pointer;
+    using attributes = metadata_with_attributes<Attributes>;
+};
+
+template<typename Name, typename Value, typename Attributes>
+struct metadata_facets<enum_value<Name, Value, Attributes>>
+{
+    using name_type  = Name;
+    using value      = Value;
+    using attributes = metadata_with_attributes<Attributes>;
+};
+
+template<
+    typename Name,
+    typename Class,
+    typename BaseClasses,
+    typename Constructors,
+    typename MemberFunctions,
+    typename MemberVariables,
+    typename Classes,
+    typename Enums,
+    typename Attributes>
+constexpr entity_kind metadata_facets<class_<
+    Name,
+    Class,
+    BaseClasses,
+    Constructors,
+    MemberFunctions,
+    MemberVariables,
+    Classes,
+    Enums,
+    Attributes>>::kind;
+template<typename Name, typename Enum, typename Values, typename Attributes>
+constexpr entity_kind
+    metadata_facets<enum_<Name, Enum, Values, Attributes>>::kind;
+
+template<typename Type>
+using metadata_facets_of_type = metadata_facets<metadata_of_type<Type>>;
+
+template<typename Pointer>
+struct member_pointer_traits;
+
+template<typename T, typename Class>
+struct member_pointer_traits<T Class::*>
+{
+    using member_type = T;
+    using class_type  = Class;
+};
+
+template<typename Pointer, std::size_t Offset, std::size_t Size>
+struct member_layout
+{
+    using pointer = Pointer;
+    using type    = typename member_pointer_traits<
+        typename Pointer::value_type>::member_type;
+
+    static constexpr std::size_t offset    = Offset;
+    static constexpr std::size_t size      = Size;
+    static constexpr std::size_t alignment = alignof(type);
+};
+
+template<typename Pointer, std::size_t Offset, std::size_t Size>
+constexpr std::size_t member_layout<Pointer, Offset, Size>::offset;
+template<typename Pointer, std::size_t Offset, std::size_t Size>
+constexpr std::size_t member_layout<Pointer, Offset, Size>::size;
+template<typename Pointer, std::size_t Offset, std::size_t Size>
+constexpr std::size_t member_layout<Pointer, Offset, Size>::alignment;
+
+// True if equal objects of type T have equal bytes. The standard trait is
+// used if available, otherwise integral, enum and pointer types, arrays of
+// them and reflected classes with an unique object representations layout
+// are considered unique
+template<typename T, typename = void>
+struct has_unique_object_representations;
+
+struct field_layout
+{
+    std::size_t offset;
+    std::size_t size;
+    std::size_t alignment;
+};
+
+template<std::size_t Size>
+struct member_field_layout
+{
+    template<typename Member>
+    static constexpr field_layout element()
+    {
+        return {Member::offset, Member::size, Member::alignment};
+    }
+
+    static constexpr field_layout sentinel()
+    {
+        return {Size, 0, 1};
+    }
+};
+
+template<std::size_t Size, std::size_t Alignment, typename Members>
+struct class_layout;
+
+template<std::size_t Size, std::size_t Alignment, typename... Members>
+struct class_layout<Size, Alignment, tinyrefl::meta::list<Members...>>
+{
+    using members = tinyrefl::meta::list<Members...>;
+
+    static constexpr std::size_t size      = Size;
+    static constexpr std::size_t alignment = Alignment;
+
+    // Offset, size and alignment of each member (Plus an empty field at the
+    // end of the class)
+    using fields_table =
+        static_table<field_layout, member_field_layout<Size>, members>;
+
+    static constexpr std::size_t field_count = fields_table::count;
+    static constexpr const typename fields_table::array_type& fields =
+        fields_table::values;
+
+    // Bytes of the class not covered by reflected members. This includes
+    // base classes and members that are not reflected
+#ifdef TINYREFL_HAS_FOLD_EXPRESSIONS
+    static constexpr std::size_t padding =
+        Size - (std::size_t{0} + ... + Members::size);
+#else
+    static constexpr std::size_t padding =
+        Size - sum_of({Members::size..., 0});
+#endif // TINYREFL_HAS_FOLD_EXPRESSIONS
+
+    // True if the class has no padding and all its members have unique
+    // object representations, so objects can be hashed and compared
+    // byte per byte
+#ifdef TINYREFL_HAS_FOLD_EXPRESSIONS
+    static constexpr bool unique_object_representations =
+        padding == 0 &&
+        (has_unique_object_representations<typename Members::type>::value &&
+         ...);
+#else
+    static constexpr bool unique_object_representations =
+        padding == 0 && all_of({has_unique_object_representations<
+                                    typename Members::type>::value...,
+                                true});
+#endif // TINYREFL_HAS_FOLD_EXPRESSIONS
+};
+
+template<std::size_t Size, std::size_t Alignment, typename... Members>
+constexpr std::size_t
+    class_layout<Size, Alignment, tinyrefl::meta::list<Members...>>::size;
+template<std::size_t Size, std::size_t Alignment, typename... Members>
+constexpr std::size_t
+    class_layout<Size, Alignment, tinyrefl::meta::list<Members...>>::
+        alignment;
+template<std::size_t Size, std::size_t Alignment, typename... Members>
+constexpr std::size_t
+    class_layout<Size, Alignment, tinyrefl::meta::list<Members...>>::
+        field_count;
+template<std::size_t Size, std::size_t Alignment, typename... Members>
+constexpr const typename class_layout<
+    Size,
+    Alignment,
+    tinyrefl::meta::list<Members...>>::fields_table::array_type&
+    class_layout<Size, Alignment, tinyrefl::meta::list<Members...>>::fields;
+template<std::size_t Size, std::size_t Alignment, typename... Members>
+constexpr std::size_t
+    class_layout<Size, Alignment, tinyrefl::meta::list<Members...>>::padding;
+template<std::size_t Size, std::size_t Alignment, typename... Members>
+constexpr bool
+    class_layout<Size, Alignment, tinyrefl::meta::list<Members...>>::
+        unique_object_representations;
+
+// Class layouts computed by tinyrefl-tool (--layout) from the clang
+// record layout
+template<typename Class>
+struct layout_of
+{
+    using type = no_metadata;
+};
+
+template<typename Class>
+struct layout_registered_for_type
+    : public tinyrefl::meta::bool_<
+          !std::is_same<typename layout_of<Class>::type, no_metadata>::value>
+{
+};
+
+template<typename Class>
+using layout_of_type = typename layout_of<Class>::type;
+
+#if defined(__cpp_lib_has_unique_object_representations)
+template<typename T, typename>
+struct has_unique_object_representations
+    : public std::has_unique_object_representations<T>
+{
+};
+#else
+template<typename T, typename>
+struct has_unique_object_representations
+    : public tinyrefl::meta::bool_<
+          std::is_integral<T>::value || std::is_enum<T>::value ||
+          std::is_pointer<T>::value>
+{
+};
+
+template<typename T, std::size_t N>
+struct has_unique_object_representations<T[N], void>
+    : public has_unique_object_representations<T>
+{
+};
+
+template<typename T>
+struct has_unique_object_representations<
+    T,
+    typename std::enable_if<layout_registered_for_type<T>::value>::type>
+    : public tinyrefl::meta::bool_<
+          layout_of_type<T>::unique_object_representations>
+{
+};
+#endif // __cpp_lib_has_unique_object_representations
+
 template<typename Entity>
 struct has_custom_display_name
     : tinyrefl::meta::bool_<
@@ -1067,6 +2277,24 @@ constexpr auto display_name() -> std::
     return Entity::display_name;
 }
 
+// Sequential entity IDs assigned by tinyrefl-tool (--id-map), indexed by
+// entity full name hash
+constexpr std::size_t invalid_entity_id = static_cast<std::size_t>(-1);
+
+template<typename Hash>
+struct entity_id_of_name
+    : public std::integral_constant<std::size_t, invalid_entity_id>
+{
+};
+
+template<typename Entity>
+constexpr std::size_t entity_id()
+{
+    return entity_id_of_name<
+        hash_constant<tinyrefl::backend::full_display_name<Entity>().hash()>>::
+        value;
+}
+
 } // namespace backend
 } // namespace tinyrefl
 
@@ -1156,6 +2384,12 @@ constexpr auto display_name() -> std::
         TINYREFL_PP_UNWRAP value,                                    \
         TINYREFL_PP_UNWRAP attributes>
 
+#define TINYREFL_MEMBER_LAYOUT(pointer, offset, size) \
+    ::tinyrefl::backend::member_layout<                 \
+        TINYREFL_PP_UNWRAP pointer,                     \
+        TINYREFL_PP_UNWRAP offset,                      \
+        TINYREFL_PP_UNWRAP size>
+
 #define TINYREFL_REFLECT_MEMBER_IMPL(...)                                \
     namespace tinyrefl                                                   \
     {                                                                    \
@@ -1262,6 +2496,35 @@ constexpr auto display_name() -> std::
     } /* namespace backend */                                        \
     } // namespace tinyrefl
 
+#define TINYREFL_REFLECT_LAYOUT(classtype, size, alignment, members) \
+    namespace tinyrefl                                                \
+    {                                                                 \
+    namespace backend                                                 \
+    {                                                                 \
+    template<>                                                        \
+    struct layout_of<TINYREFL_PP_UNWRAP classtype>                    \
+    {                                                                 \
+        using type = class_layout<                                    \
+            TINYREFL_PP_UNWRAP size,                                  \
+            TINYREFL_PP_UNWRAP alignment,                             \
+            TINYREFL_PP_UNWRAP members>;                              \
+    };                                                                \
+    } /* namespace backend */                                         \
+    } // namespace tinyrefl
+
+#define TINYREFL_ENTITY_ID(name, id)                                        \
+    namespace tinyrefl                                                      \
+    {                                                                       \
+    namespace backend                                                       \
+    {                                                                       \
+    template<>                                                              \
+    struct entity_id_of_name<TINYREFL_PP_UNWRAP name>                       \
+        : public std::integral_constant<std::size_t, TINYREFL_PP_UNWRAP id> \
+    {                                                                       \
+    };                                                                      \
+    } /* namespace backend */                                               \
+    } // namespace tinyrefl
+
 #define TINYREFL_GODMODE                                        \
     struct tinyrefl_godmode_tag                                 \
     {                                                           \
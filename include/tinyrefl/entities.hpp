@@ -8,6 +8,8 @@
     "To use this header, first include your reflected headers, then <tinyrefl/api.hpp>, then your reflected headers generated code (.tinyrefl header files), and then this header"
 #endif
 
+#include <tinyrefl/registry.hpp>
+
 namespace tinyrefl
 {
 
@@ -68,6 +70,19 @@ void visit_enums(Visitor visitor)
 {
     visit_entities<tinyrefl::entity::ENUM>(visitor);
 }
+
+// Registry of all the reflected classes of the TU. Declare it as a
+// constexpr variable to get it constant initialized:
+//
+//     constexpr tinyrefl::type_registry registry =
+//         tinyrefl::make_type_registry_from_entities();
+//
+// (A template so TUs with different entities get different functions)
+template<typename Entities = tinyrefl::entities>
+constexpr type_registry make_type_registry_from_entities()
+{
+    return tinyrefl::make_type_registry<Entities>();
+}
 } // namespace tinyrefl
 
 #endif // TINYREFL_ENTITIES_HPP_INCLUDED
@@ -0,0 +1,321 @@
+#ifndef TINYREFL_REGISTRY_HPP_INCLUDED
+#define TINYREFL_REGISTRY_HPP_INCLUDED
+
+#include <cstdint>
+#include <stdexcept>
+#include <tinyrefl/api.hpp>
+#include <type_traits>
+
+namespace tinyrefl
+{
+
+// Runtime description of a reflected class
+struct type_descriptor
+{
+    ctti::detail::cstring name;
+    // Hash of the full name of the class, as in "ns::Class"_id
+    ctti::detail::hash_t hash;
+    std::size_t          size;
+    std::size_t          alignment;
+    tinyrefl::backend::array_view<field_descriptor> fields;
+};
+
+namespace detail
+{
+
+constexpr std::uint64_t
+    registry_hash(const ctti::detail::hash_t hash, const std::uint64_t seed)
+{
+    std::uint64_t x = hash ^ (seed * 0x9e3779b97f4a7c15ull);
+    x               = (x ^ (x >> 33)) * 0xff51afd7ed558ccdull;
+    return x ^ (x >> 33);
+}
+
+// Perfect hash of the types of a registry (Hash and displace): Types are
+// grouped in buckets by hash, and each bucket has a displacement so all
+// the types of the bucket land in free slots. Slots store the index of
+// their type plus one, zero for empty slots
+template<std::size_t Count>
+struct registry_index
+{
+    static constexpr std::size_t bucket_count =
+        tinyrefl::backend::next_power_of_two(Count);
+    static constexpr std::size_t slot_count   = 2 * bucket_count;
+
+    std::uint64_t displacements[bucket_count];
+    std::size_t   slots[slot_count];
+};
+
+template<std::size_t Count>
+constexpr std::size_t registry_index<Count>::bucket_count;
+template<std::size_t Count>
+constexpr std::size_t registry_index<Count>::slot_count;
+
+template<std::size_t Count>
+constexpr bool place_registry_bucket(
+    registry_index<Count>&      index,
+    const ctti::detail::hash_t* hashes,
+    const std::size_t           bucket,
+    const std::uint64_t         displacement)
+{
+    using index_type = registry_index<Count>;
+
+    for(std::size_t i = 0; i < Count; ++i)
+    {
+        if((registry_hash(hashes[i], 0) & (index_type::bucket_count - 1)) !=
+           bucket)
+        {
+            continue;
+        }
+
+        const std::size_t slot = registry_hash(hashes[i], displacement) &
+                                 (index_type::slot_count - 1);
+
+        if(index.slots[slot] != 0)
+        {
+            // Undo the types of the bucket placed so far
+            for(std::size_t j = 0; j < i; ++j)
+            {
+                if((registry_hash(hashes[j], 0) &
+                    (index_type::bucket_count - 1)) == bucket)
+                {
+                    index.slots[registry_hash(hashes[j], displacement) &
+                                (index_type::slot_count - 1)] = 0;
+                }
+            }
+
+            return false;
+        }
+
+        index.slots[slot] = i + 1;
+    }
+
+    index.displacements[bucket] = displacement;
+    return true;
+}
+
+template<std::size_t Count>
+constexpr registry_index<Count>
+    make_registry_index(const ctti::detail::hash_t (&hashes)[Count + 1])
+{
+    using index_type = registry_index<Count>;
+
+    index_type  index{};
+    std::size_t bucket_sizes[index_type::bucket_count] = {};
+    std::size_t max_bucket_size                        = 0;
+
+    for(std::size_t i = 0; i < Count; ++i)
+    {
+        // No displacement can tell two equal hashes apart
+        for(std::size_t j = i + 1; j < Count; ++j)
+        {
+            if(hashes[i] == hashes[j])
+            {
+                throw std::logic_error{
+                    "tinyrefl type registry: Duplicated type hashes"};
+            }
+        }
+
+        const std::size_t bucket =
+            registry_hash(hashes[i], 0) & (index_type::bucket_count - 1);
+
+        max_bucket_size = ctti::detail::max(
+            max_bucket_size, ++bucket_sizes[bucket]);
+    }
+
+    // Biggest buckets first, while most of the slots are still free
+    for(std::size_t size = max_bucket_size; size > 0; --size)
+    {
+        for(std::size_t bucket = 0; bucket < index_type::bucket_count;
+            ++bucket)
+        {
+            if(bucket_sizes[bucket] != size)
+            {
+                continue;
+            }
+
+            std::uint64_t displacement = 1;
+
+            while(!place_registry_bucket(
+                index, &hashes[0], bucket, displacement))
+            {
+                if(++displacement > 4 * index_type::slot_count)
+                {
+                    throw std::logic_error{
+                        "tinyrefl type registry: No displacement found for "
+                        "a bucket of the perfect hash"};
+                }
+            }
+        }
+    }
+
+    return index;
+}
+
+template<typename Entity>
+struct is_class_metadata
+{
+    using type =
+        tinyrefl::meta::bool_<Entity::kind == tinyrefl::entity::CLASS>;
+};
+
+template<typename... Ts>
+struct inherit_all : public tinyrefl::type_tag<Ts>...
+{
+};
+
+// Appends T to the list unless it is already there (Entity lists may have
+// the same entity more than once)
+template<typename List, typename T>
+struct append_unique;
+
+template<typename... Ts, typename T>
+struct append_unique<tinyrefl::meta::list<Ts...>, T>
+{
+    using type = std::conditional_t<
+        std::is_base_of<tinyrefl::type_tag<T>, inherit_all<Ts...>>::value,
+        tinyrefl::meta::list<Ts...>,
+        tinyrefl::meta::list<Ts..., T>>;
+};
+
+struct class_type_descriptor
+{
+    template<typename Class>
+    static constexpr type_descriptor element()
+    {
+        return {Class::name.full_name(),
+                Class::name.full_name().hash(),
+                sizeof(typename Class::class_type),
+                alignof(typename Class::class_type),
+                tinyrefl::fields<typename Class::class_type>()};
+    }
+
+    static constexpr type_descriptor sentinel()
+    {
+        return {"", 0, 0, 1, {nullptr, nullptr}};
+    }
+};
+
+struct class_hash
+{
+    template<typename Class>
+    static constexpr ctti::detail::hash_t element()
+    {
+        return Class::name.full_name().hash();
+    }
+
+    static constexpr ctti::detail::hash_t sentinel()
+    {
+        return 0;
+    }
+};
+
+template<typename Classes>
+struct type_registry_table
+{
+    using types = tinyrefl::backend::
+        static_table<type_descriptor, class_type_descriptor, Classes>;
+    using hashes = tinyrefl::backend::
+        static_table<ctti::detail::hash_t, class_hash, Classes>;
+
+    static constexpr std::size_t count = types::count;
+
+    static constexpr registry_index<count> index =
+        make_registry_index<count>(hashes::values);
+};
+
+template<typename Classes>
+constexpr std::size_t type_registry_table<Classes>::count;
+template<typename Classes>
+constexpr registry_index<type_registry_table<Classes>::count>
+    type_registry_table<Classes>::index;
+} // namespace detail
+
+// Read only table of type descriptors with a perfect hash index, built at
+// compile time. Registries are constant initialized and lookups take no
+// locks, so they can be used from any thread at any time
+class type_registry
+{
+public:
+    template<std::size_t Count>
+    constexpr type_registry(
+        const tinyrefl::backend::array_view<type_descriptor>& types,
+        const detail::registry_index<Count>&                 index)
+        : _types{types},
+          _displacements{&index.displacements[0]},
+          _slots{&index.slots[0]},
+          _bucket_mask{detail::registry_index<Count>::bucket_count - 1},
+          _slot_mask{detail::registry_index<Count>::slot_count - 1}
+    {
+    }
+
+    // Returns nullptr if there's no type with that hash
+    constexpr const type_descriptor*
+        find(const ctti::detail::hash_t hash) const
+    {
+        const std::uint64_t displacement =
+            _displacements[detail::registry_hash(hash, 0) & _bucket_mask];
+        const std::size_t index =
+            _slots[detail::registry_hash(hash, displacement) & _slot_mask];
+
+        if(index != 0 && _types[index - 1].hash == hash)
+        {
+            return _types.begin() + index - 1;
+        }
+        else
+        {
+            return nullptr;
+        }
+    }
+
+    // Returns nullptr if there's no type with that full name
+    constexpr const type_descriptor*
+        find(const ctti::detail::cstring& name) const
+    {
+        const type_descriptor* type = find(name.hash());
+
+        if(type != nullptr && type->name == name)
+        {
+            return type;
+        }
+        else
+        {
+            return nullptr;
+        }
+    }
+
+    constexpr const tinyrefl::backend::array_view<type_descriptor>&
+        types() const
+    {
+        return _types;
+    }
+
+private:
+    tinyrefl::backend::array_view<type_descriptor> _types;
+    const std::uint64_t*                           _displacements;
+    const std::size_t*                             _slots;
+    std::size_t                                    _bucket_mask;
+    std::size_t                                    _slot_mask;
+};
+
+// Registry of the classes of a list of metadata (Entities other than
+// classes and repeated entities are ignored). Declare the registry as a
+// constexpr variable to get it constant initialized. See also
+// make_type_registry_from_entities() in <tinyrefl/entities.hpp>
+template<typename Entities>
+constexpr type_registry make_type_registry()
+{
+    using classes = tinyrefl::meta::foldl_t<
+        tinyrefl::meta::defer<detail::append_unique>,
+        tinyrefl::meta::list<>,
+        tinyrefl::meta::filter_t<
+            tinyrefl::meta::defer<detail::is_class_metadata>,
+            Entities>>;
+    using table = detail::type_registry_table<classes>;
+
+    return {{table::types::values, table::types::values + table::count},
+            table::index};
+}
+} // namespace tinyrefl
+
+#endif // TINYREFL_REGISTRY_HPP_INCLUDED
@@ -1,6 +1,7 @@
 #ifndef TINYREFL_UTILS_DEMANGLE_HPP
 #define TINYREFL_UTILS_DEMANGLE_HPP
 
+#include <ctti/detail/cstring.hpp>
 #include <string>
 
 namespace tinyrefl
@@ -9,8 +10,14 @@ namespace tinyrefl
 namespace utils
 {
 
+// Returns the name as is if it cannot be demangled
 std::string demangle(const std::string& name);
-}
+
+// Demangles a name once and returns a view of the demangled name, valid
+// until the end of the program. Names are cached by address, so name must
+// have static storage duration (Such as the result of type_info::name())
+ctti::detail::cstring demangle_interned(const char* name);
+} // namespace utils
 } // namespace tinyrefl
 
 #endif // TINYREFL_UTILS_DEMANGLE_HPP
@@ -1,7 +1,9 @@
 #ifndef TINYREFL_UTILS_TYPENAME_HPP
 #define TINYREFL_UTILS_TYPENAME_HPP
 
+#include <ctti/detail/cstring.hpp>
 #include <ctti/detail/language_features.hpp>
+#include <string>
 
 #ifdef CTTI_HAS_CONSTEXPR_PRETTY_FUNCTION
 #include <ctti/nameof.hpp>
@@ -12,10 +14,17 @@ namespace tinyrefl
 namespace utils
 {
 
+// View of the name of the type, computed at compile time
+template<typename T>
+constexpr ctti::detail::cstring type_name_view()
+{
+    return ctti::nameof<T>();
+}
+
 template<typename T>
 const std::string& type_name()
 {
-    static std::string name{ctti::nameof<T>().str()};
+    static const std::string name{type_name_view<T>().str()};
     return name;
 }
 } // namespace utils
@@ -23,7 +32,7 @@ const std::string& type_name()
 
 #else
 #include <tinyrefl/utils/demangle.hpp>
-#include <type_info>
+#include <typeinfo>
 
 namespace tinyrefl
 {
@@ -31,10 +40,40 @@ namespace tinyrefl
 namespace utils
 {
 
+// Demangled names are stored per type during static initialization, so
+// looking a name up later is a plain load
+template<typename T>
+struct type_name_storage
+{
+    static const ctti::detail::cstring value;
+};
+
+template<typename T>
+const ctti::detail::cstring type_name_storage<T>::value =
+    tinyrefl::utils::demangle_interned(typeid(T).name());
+
+// View of the name of the type, valid until the end of the program
+template<typename T>
+ctti::detail::cstring type_name_view()
+{
+    // Still empty if used during static initialization, before the
+    // storage of T was initialized
+    const ctti::detail::cstring name = type_name_storage<T>::value;
+
+    if(name.size() != 0)
+    {
+        return name;
+    }
+    else
+    {
+        return tinyrefl::utils::demangle_interned(typeid(T).name());
+    }
+}
+
 template<typename T>
 const std::string& type_name()
 {
-    static std::string name{tinyrefl::utils::demangle(typeid(T).name())};
+    static const std::string name{type_name_view<T>().str()};
     return name;
 }
 } // namespace utils
@@ -1,5 +1,7 @@
 #include <tinyrefl/utils/demangle.hpp>
 
+#include <mutex>
+#include <unordered_map>
 
 #if defined(_MSC_VER)
 #include <Dbghelp.h>
@@ -9,28 +11,32 @@ namespace tinyrefl
 namespace utils
 {
 
+namespace
+{
+
 constexpr std::size_t UNDECORATED_NAME_LENGHT = 512;
 
-std::string demangle(const std::string& name)
+// Returns the demangled name in a thread local buffer reused by all calls
+// from the thread, or nullptr if the name could not be demangled
+const char* demangle_to_buffer(const char* name)
 {
-    char output_buffer[UNDECORATED_NAME_LENGHT];
+    thread_local char output_buffer[UNDECORATED_NAME_LENGHT];
 
     if(!FAILED(UnDecorateSymbolName(
-           name.c_str(),
-           output_buffer,
-           UNDECORATED_NAME_LENGHT,
-           UNDNAME_COMPLETE)))
+           name, output_buffer, UNDECORATED_NAME_LENGHT, UNDNAME_COMPLETE)))
     {
-        return std::string(output_buffer);
+        return output_buffer;
     }
     else
     {
-        return name;
+        return nullptr;
     }
 }
+} // namespace
 } // namespace utils
 } // namespace tinyrefl
 #elif defined(__GNUC__) || defined(__llvm__)
+#include <cstdlib>
 #include <cxxabi.h>
 
 namespace tinyrefl
@@ -38,23 +44,40 @@ namespace tinyrefl
 namespace utils
 {
 
-std::string demangle(const std::string& name)
+namespace
 {
-    int status;
 
-    char* demangled_name = abi::__cxa_demangle(name.c_str(), 0, 0, &status);
+struct demangle_buffer
+{
+    char*       data = nullptr;
+    std::size_t size = 0;
 
-    if(status != 0)
-        throw;
+    ~demangle_buffer()
+    {
+        std::free(data);
+    }
+};
+
+// Returns the demangled name in a thread local buffer reused by all calls
+// from the thread, or nullptr if the name could not be demangled. The
+// buffer is malloc()ed and grown by __cxa_demangle() itself, with realloc()
+const char* demangle_to_buffer(const char* name)
+{
+    thread_local demangle_buffer buffer;
 
-    std::string result{demangled_name};
+    int   status = 0;
+    char* demangled_name =
+        abi::__cxa_demangle(name, buffer.data, &buffer.size, &status);
 
-    std::free(demangled_name); // IMPORTANT! The result of __cxa_demangle() was
-                               // malloc()ed, should be released
-    // using free(). See __cxa_demangle() documentation.
+    if(status != 0)
+    {
+        return nullptr;
+    }
 
-    return result;
+    buffer.data = demangled_name;
+    return demangled_name;
 }
+} // namespace
 } // namespace utils
 } // namespace tinyrefl
 #else /* Others (Currently unsupported platforms. The name is returned as is) \
@@ -64,10 +87,59 @@ namespace tinyrefl
 namespace utils
 {
 
-std::string demangle(const std::string& name)
+namespace
+{
+
+const char* demangle_to_buffer(const char* name)
 {
     return name;
 }
+} // namespace
 } // namespace utils
 } // namespace tinyrefl
 #endif
+
+namespace tinyrefl
+{
+namespace utils
+{
+
+std::string demangle(const std::string& name)
+{
+    const char* demangled_name = demangle_to_buffer(name.c_str());
+
+    if(demangled_name != nullptr)
+    {
+        return demangled_name;
+    }
+    else
+    {
+        return name;
+    }
+}
+
+ctti::detail::cstring demangle_interned(const char* name)
+{
+    // Function local statics so names can be demangled during static
+    // initialization of other translation units. Map nodes are never moved
+    // nor released, so views of the interned strings stay valid
+    static std::mutex                                   mutex;
+    static std::unordered_map<const char*, std::string> interned_names;
+
+    std::lock_guard<std::mutex> lock{mutex};
+    auto                        it = interned_names.find(name);
+
+    if(it == interned_names.end())
+    {
+        const char* demangled_name = demangle_to_buffer(name);
+
+        it = interned_names
+                 .emplace(
+                     name, demangled_name != nullptr ? demangled_name : name)
+                 .first;
+    }
+
+    return {it->second.data(), it->second.size()};
+}
+} // namespace utils
+} // namespace tinyrefl
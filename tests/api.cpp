@@ -6,6 +6,71 @@
 #include "example.hpp.tinyrefl"
 
 using namespace std::string_literals;
+using namespace tinyrefl::literals;
+
+// Enums with no values and with more values than visit_enum() dispatches
+// with a chain of comparisons
+namespace visit_enum_tests
+{
+enum class Empty
+{
+};
+
+enum class Dense
+{
+    V0, V1, V2, V3, V4, V5, V6, V7, V8
+};
+} // namespace visit_enum_tests
+
+TINYREFL_DEFINE_STRING(visit_enum_tests::Empty)
+TINYREFL_DEFINE_STRING(visit_enum_tests::Dense)
+TINYREFL_DEFINE_STRING(visit_enum_tests::Dense::V0)
+TINYREFL_DEFINE_STRING(visit_enum_tests::Dense::V1)
+TINYREFL_DEFINE_STRING(visit_enum_tests::Dense::V2)
+TINYREFL_DEFINE_STRING(visit_enum_tests::Dense::V3)
+TINYREFL_DEFINE_STRING(visit_enum_tests::Dense::V4)
+TINYREFL_DEFINE_STRING(visit_enum_tests::Dense::V5)
+TINYREFL_DEFINE_STRING(visit_enum_tests::Dense::V6)
+TINYREFL_DEFINE_STRING(visit_enum_tests::Dense::V7)
+TINYREFL_DEFINE_STRING(visit_enum_tests::Dense::V8)
+
+TINYREFL_REFLECT_ENUM(
+    (TINYREFL_STRING(visit_enum_tests::Empty)),
+    (visit_enum_tests::Empty),
+    (tinyrefl::meta::list<>),
+    (tinyrefl::meta::list<>))
+TINYREFL_REFLECT_ENUM(
+    (TINYREFL_STRING(visit_enum_tests::Dense)),
+    (visit_enum_tests::Dense),
+    (tinyrefl::meta::list<
+        tinyrefl::backend::enum_value<
+            TINYREFL_STRING(visit_enum_tests::Dense::V0),
+            CTTI_STATIC_VALUE(visit_enum_tests::Dense::V0)>,
+        tinyrefl::backend::enum_value<
+            TINYREFL_STRING(visit_enum_tests::Dense::V1),
+            CTTI_STATIC_VALUE(visit_enum_tests::Dense::V1)>,
+        tinyrefl::backend::enum_value<
+            TINYREFL_STRING(visit_enum_tests::Dense::V2),
+            CTTI_STATIC_VALUE(visit_enum_tests::Dense::V2)>,
+        tinyrefl::backend::enum_value<
+            TINYREFL_STRING(visit_enum_tests::Dense::V3),
+            CTTI_STATIC_VALUE(visit_enum_tests::Dense::V3)>,
+        tinyrefl::backend::enum_value<
+            TINYREFL_STRING(visit_enum_tests::Dense::V4),
+            CTTI_STATIC_VALUE(visit_enum_tests::Dense::V4)>,
+        tinyrefl::backend::enum_value<
+            TINYREFL_STRING(visit_enum_tests::Dense::V5),
+            CTTI_STATIC_VALUE(visit_enum_tests::Dense::V5)>,
+        tinyrefl::backend::enum_value<
+            TINYREFL_STRING(visit_enum_tests::Dense::V6),
+            CTTI_STATIC_VALUE(visit_enum_tests::Dense::V6)>,
+        tinyrefl::backend::enum_value<
+            TINYREFL_STRING(visit_enum_tests::Dense::V7),
+            CTTI_STATIC_VALUE(visit_enum_tests::Dense::V7)>,
+        tinyrefl::backend::enum_value<
+            TINYREFL_STRING(visit_enum_tests::Dense::V8),
+            CTTI_STATIC_VALUE(visit_enum_tests::Dense::V8)>>),
+    (tinyrefl::meta::list<>))
 
 TEST_CASE("tinyrefl api")
 {
@@ -34,6 +99,22 @@ TEST_CASE("tinyrefl api")
             &my_namespace::MyClass::f);
         REQUIRE(!tinyrefl::has_attribute<my_namespace::MyClass>("foo"));
 
+        SECTION("all member variables include the base classes ones")
+        {
+            using variables = Metadata::all_member_variables;
+
+            static_assert(variables::size == 4, "");
+            REQUIRE(
+                tinyrefl::meta::get_t<0, variables>::value ==
+                &my_namespace::Foo::vector);
+            REQUIRE(
+                tinyrefl::meta::get_t<1, variables>::value ==
+                &my_namespace::MyClass::str);
+            REQUIRE(
+                tinyrefl::meta::get_t<3, variables>::value ==
+                &my_namespace::MyClass::enum_value);
+        }
+
         SECTION(
             "overloaded functions are exposed as different member functions")
         {
@@ -727,6 +808,28 @@ TEST_CASE("tinyrefl api")
                 });
         }
 
+        SECTION("member names are views of static strings")
+        {
+            my_namespace::MyClass    myObject;
+            std::vector<const char*> names;
+
+            for(int i = 0; i < 2; ++i)
+            {
+                tinyrefl::visit_member_variables(
+                    myObject,
+                    [&names](
+                        const ctti::detail::cstring& name,
+                        const auto& /* member */) {
+                        names.push_back(name.begin());
+                    });
+            }
+
+            REQUIRE(names.size() == 8);
+            CHECK(std::equal(
+                names.begin(), names.begin() + 4, names.begin() + 4));
+            CHECK(ctti::detail::cstring{names[1], 3} == "str");
+        }
+
         SECTION(
             "assigning values to members in visit changes members of visited object")
         {
@@ -767,6 +870,47 @@ TEST_CASE("tinyrefl api")
         }
     }
 
+    SECTION("compact visitation")
+    {
+        my_namespace::MyClass myObject;
+        std::unordered_map<std::string, const void*> fields;
+
+        tinyrefl::visit_fields(
+            myObject,
+            [&fields](const tinyrefl::field_descriptor& field, void* value) {
+                fields[field.name.str()] = value;
+            });
+
+        REQUIRE(fields.size() == 4);
+        CHECK(fields["vector"] == std::addressof(myObject.vector));
+        CHECK(fields["str"] == std::addressof(myObject.str));
+        CHECK(
+            fields["innerClassInstance"] ==
+            std::addressof(myObject.innerClassInstance));
+        CHECK(fields["enum_value"] == std::addressof(myObject.enum_value));
+
+        const my_namespace::MyClass& constObject = myObject;
+        std::size_t                  count       = 0;
+
+        tinyrefl::visit_fields(
+            constObject,
+            [&count, &constObject](
+                const tinyrefl::field_descriptor& field, const void* value) {
+                if(field.type_id == ctti::nameof<std::string>().hash())
+                {
+                    CHECK(field.name == "str");
+                    CHECK(field.size == sizeof(std::string));
+                    CHECK(
+                        *static_cast<const std::string*>(value) ==
+                        constObject.str);
+                }
+
+                ++count;
+            });
+
+        CHECK(count == 4);
+    }
+
     SECTION("tuple converters")
     {
         auto addressof = [](const auto& object) {
@@ -807,6 +951,30 @@ TEST_CASE("tinyrefl api")
         }
     }
 
+    SECTION("member access by name")
+    {
+        my_namespace::MyClass       myObject;
+        const my_namespace::MyClass& constObject = myObject;
+
+        static_assert(
+            tinyrefl::member_index<my_namespace::MyClass>("enum_value") == 2,
+            "Wrong member index");
+
+        tinyrefl::get<"str"_id>(myObject) = "hello";
+        tinyrefl::get<"innerClassInstance"_id>(myObject).a = 42;
+
+        CHECK(myObject.str == "hello");
+        CHECK(myObject.innerClassInstance.a == 42);
+        CHECK(
+            std::addressof(tinyrefl::get<"enum_value"_id>(constObject)) ==
+            std::addressof(myObject.enum_value));
+        static_assert(
+            std::is_same<
+                decltype(tinyrefl::get<"str"_id>(constObject)),
+                const std::string&>::value,
+            "Const objects give const references");
+    }
+
     SECTION("enum converters")
     {
         using Enum = my_namespace::MyClass::Enum;
@@ -835,6 +1003,202 @@ TEST_CASE("tinyrefl api")
             CHECK(tinyrefl::enum_cast<Enum>("D"s) == Enum::D);
         }
 
+        SECTION("enum_cast_case_insensitive()")
+        {
+            CHECK(tinyrefl::enum_cast_case_insensitive<Enum>("a") == Enum::A);
+            CHECK(tinyrefl::enum_cast_case_insensitive<Enum>("B") == Enum::B);
+            CHECK(tinyrefl::enum_cast_case_insensitive<Enum>("c"s) == Enum::C);
+            CHECK(tinyrefl::enum_cast_case_insensitive<Enum>("d"s) == Enum::D);
+        }
+
+        SECTION("is_enumerated_value(string)")
+        {
+            constexpr auto metadata = tinyrefl::metadata<Enum>();
+
+            CHECK(metadata.is_enumerated_value("D"));
+            CHECK_FALSE(metadata.is_enumerated_value("d"));
+            CHECK_FALSE(metadata.is_enumerated_value("E"));
+            CHECK_FALSE(metadata.is_enumerated_value(""));
+            CHECK(metadata.is_enumerated_value_case_insensitive("d"));
+            CHECK_FALSE(metadata.is_enumerated_value_case_insensitive("AB"));
+        }
+
+        SECTION("value attributes")
+        {
+            constexpr auto metadata = tinyrefl::metadata<Enum>();
+
+            CHECK(metadata.get_value(Enum::A).has_attribute("A"));
+            CHECK(
+                metadata.get_value(Enum::A).get_attribute("A").name.name() ==
+                "A");
+            CHECK_FALSE(metadata.get_value(Enum::B).has_attribute("A"));
+            CHECK(metadata.get_value(Enum::B).get_attributes().size() == 0);
+        }
+
+        SECTION("validate_enum_values()")
+        {
+            // Enum values are A = 0, B = 1, C = 2, D = 42
+            std::vector<int> values(100, 42);
+            values[10] = 1;
+            values[70] = 3;
+            values[90] = -1;
+
+            CHECK(tinyrefl::validate_enum_values<Enum>(
+                      values.data(), values.data() + 70) == 70);
+            CHECK(tinyrefl::validate_enum_values<Enum>(
+                      values.data(), values.data() + values.size()) == 70);
+            CHECK(tinyrefl::validate_enum_values<Enum>(
+                      values.data() + 71, values.data() + values.size()) ==
+                  19);
+
+            std::uint64_t mask[2];
+            CHECK(tinyrefl::validate_enum_values<Enum>(
+                      {values.data(), values.data() + values.size()}, mask) ==
+                  2);
+            CHECK(mask[0] == ~std::uint64_t{0});
+            CHECK(
+                mask[1] == (((std::uint64_t{1} << 36) - 1) &
+                            ~(std::uint64_t{1} << (70 - 64)) &
+                            ~(std::uint64_t{1} << (90 - 64))));
+        }
+
+        SECTION("enum_set")
+        {
+            using set = tinyrefl::enum_set<Enum>;
+
+            constexpr set empty;
+            constexpr set ab{Enum::A, Enum::B};
+            constexpr set bd{Enum::B, Enum::D};
+
+            static_assert(set::capacity == 4, "");
+            static_assert(sizeof(set) == sizeof(std::uint64_t), "");
+            static_assert(ab.contains(Enum::A), "");
+            static_assert(!ab.contains(Enum::D), "");
+            static_assert((ab | bd).size() == 3, "");
+            static_assert((ab & bd) == set{Enum::B}, "");
+            static_assert((ab ^ bd) == set{Enum::A, Enum::D}, "");
+            static_assert((ab - bd) == set{Enum::A}, "");
+            static_assert(~ab == set{Enum::C, Enum::D}, "");
+            static_assert(set::all().size() == 4, "");
+            static_assert(empty.empty() && !ab.empty(), "");
+
+            set values = ab;
+            values.insert(Enum::D).erase(Enum::A);
+            values.insert(static_cast<Enum>(3));
+            CHECK(values == bd);
+
+            std::vector<Enum> elements(values.begin(), values.end());
+            CHECK(elements == (std::vector<Enum>{Enum::B, Enum::D}));
+
+            CHECK(bd.to_flags() == (1 | 42));
+            CHECK(set::from_flags(1 | 2) == (set{Enum::B, Enum::C}));
+            CHECK(set::from_flags(0) == empty);
+
+            SECTION("format")
+            {
+                char buffer[set::max_formatted_size];
+                CHECK(set::max_formatted_size == 9);
+
+                CHECK(set::all().format(buffer, sizeof(buffer)) == 7);
+                CHECK(std::string{buffer} == "A|B|C|D");
+                CHECK(bd.format(buffer, 3, ',') == 3);
+                CHECK(std::string{buffer} == "B,");
+                CHECK(empty.format(buffer, sizeof(buffer)) == 0);
+                CHECK(std::string{buffer} == "");
+                CHECK(ab.str() == "A|B");
+            }
+
+            SECTION("parse")
+            {
+                set result{Enum::C};
+
+                CHECK(set::parse("A|B", result));
+                CHECK(result == ab);
+                CHECK(set::parse(" B | D ", result));
+                CHECK(result == bd);
+                CHECK(set::parse("B,A", result, ','));
+                CHECK(result == ab);
+                CHECK(set::parse("", result));
+                CHECK(result == empty);
+
+                result = ab;
+                CHECK_FALSE(set::parse("A|E", result));
+                CHECK_FALSE(set::parse("A||B", result));
+                CHECK_FALSE(set::parse("A|", result));
+                CHECK(result == ab);
+            }
+        }
+
+        SECTION("visit_enum()")
+        {
+            const auto visitor = [](auto value) {
+                constexpr Enum enumerator =
+                    decltype(value)::value_static_value::value;
+                return std::make_pair(
+                    std::string{value.value_name().begin(),
+                                value.value_name().end()},
+                    tinyrefl::underlying_value(enumerator));
+            };
+
+            CHECK(
+                tinyrefl::visit_enum(Enum::A, visitor) ==
+                std::make_pair(std::string{"A"}, 0));
+            CHECK(
+                tinyrefl::visit_enum(Enum::D, visitor) ==
+                std::make_pair(std::string{"D"}, 42));
+            CHECK(
+                tinyrefl::visit_enum(static_cast<Enum>(3), visitor) ==
+                std::make_pair(std::string{}, 0));
+            CHECK(
+                tinyrefl::visit_enum(
+                    static_cast<Enum>(3),
+                    visitor,
+                    [](const Enum value) {
+                        return std::make_pair(
+                            std::string{"invalid"},
+                            static_cast<int>(value));
+                    }) == std::make_pair(std::string{"invalid"}, 3));
+
+            int visited = 0;
+            tinyrefl::visit_enum(Enum::C, [&visited](auto value) {
+                visited = value.underlying_value();
+            });
+            CHECK(visited == 2);
+
+            // Results that are the same for all values are kept as is
+            int& visited_ref = tinyrefl::visit_enum(
+                Enum::B,
+                [&visited](auto) -> int& { return visited; },
+                [&visited](const Enum) -> int& { return visited; });
+            CHECK(&visited_ref == &visited);
+
+            const auto index_visitor = [](auto value) {
+                return static_cast<int>(value.underlying_value());
+            };
+
+            CHECK(
+                tinyrefl::visit_enum(
+                    visit_enum_tests::Dense::V0, index_visitor) == 0);
+            CHECK(
+                tinyrefl::visit_enum(
+                    visit_enum_tests::Dense::V8, index_visitor) == 8);
+            CHECK(
+                tinyrefl::visit_enum(
+                    static_cast<visit_enum_tests::Dense>(9),
+                    index_visitor,
+                    [](const visit_enum_tests::Dense) { return -1; }) == -1);
+
+            CHECK(
+                tinyrefl::visit_enum(
+                    visit_enum_tests::Empty{},
+                    index_visitor,
+                    [](const visit_enum_tests::Empty) { return -1; }) == -1);
+            static_assert(
+                std::is_void<decltype(tinyrefl::visit_enum(
+                    visit_enum_tests::Empty{}, index_visitor))>::value,
+                "Visiting an empty enum without invalid handler returns void");
+        }
+
         SECTION("to_string()")
         {
             CHECK(tinyrefl::to_string(Enum::A) == "A");
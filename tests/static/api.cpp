@@ -5,6 +5,7 @@
 #include "../example.hpp.tinyrefl"
 #include "members.hpp.tinyrefl"
 #include <tinyrefl/entities.hpp>
+#include <tinyrefl/registry.hpp>
 #include CTTI_STATIC_TESTS_HEADER
 
 #if TINYREFL_GENERATED_FILE_COUNT != 2
@@ -314,3 +315,169 @@ EXPECT_TRUE(
         tinyrefl::meta::
             filter_t<tinyrefl::meta::defer<std::is_class>, tinyrefl::entities>,
         tinyrefl::entities>::value);
+
+// Metadata facets
+EXPECT_EQ(tinyrefl::name_of<foo::Foo>().full_name(), "foo::Foo");
+EXPECT_EQ(tinyrefl::name_of<my_namespace::MyClass::Enum>().name(), "Enum");
+EXPECT_TRUE(
+    std::is_same<
+        tinyrefl::facets<my_namespace::MyClass>::member_variables,
+        tinyrefl::metadata<my_namespace::MyClass>::member_variables>::value);
+EXPECT_EQ(tinyrefl::facets<my_namespace::MyClass::Enum>::values::size, 4);
+EXPECT_TRUE(
+    tinyrefl::facets<my_namespace::MyClass::Enum>::attributes{}.has_attribute(
+        "Enum"));
+
+// Facets do not instantiate the metadata (The attributes of this class are
+// ill-formed and would fail to compile if class_<> were instantiated)
+struct facets_only
+{
+};
+
+TINYREFL_DEFINE_STRING(facets_only)
+
+namespace tinyrefl
+{
+namespace backend
+{
+template<>
+struct metadata_of<facets_only>
+{
+    using type = class_<
+        TINYREFL_STRING(facets_only),
+        facets_only,
+        tinyrefl::meta::list<>,
+        tinyrefl::meta::list<>,
+        tinyrefl::meta::list<>,
+        tinyrefl::meta::list<>,
+        tinyrefl::meta::list<>,
+        tinyrefl::meta::list<>,
+        tinyrefl::meta::list<int>>;
+};
+} // namespace backend
+} // namespace tinyrefl
+
+EXPECT_EQ(tinyrefl::name_of<facets_only>().full_name(), "facets_only");
+
+// Member lookup by name
+EXPECT_EQ(tinyrefl::member_index<my_namespace::MyClass>("str"), 0);
+EXPECT_EQ(tinyrefl::member_index<my_namespace::MyClass>("enum_value"), 2);
+EXPECT_EQ(
+    (tinyrefl::member_index<my_namespace::MyClass, "innerClassInstance"_id>()),
+    1);
+EXPECT_EQ(tinyrefl::member_index<my_namespace::MyClass>("overloaded"), 3);
+EXPECT_TRUE(tinyrefl::has_member_variable<my_namespace::MyClass>("str"));
+EXPECT_FALSE(tinyrefl::has_member_variable<my_namespace::MyClass>("foo"));
+
+// Type names are computed at compile time
+#ifdef CTTI_HAS_CONSTEXPR_PRETTY_FUNCTION
+EXPECT_EQ(
+    tinyrefl::utils::type_name_view<my_namespace::MyClass>(),
+    "my_namespace::MyClass");
+#endif // CTTI_HAS_CONSTEXPR_PRETTY_FUNCTION
+
+// Compact visitation field tables
+EXPECT_EQ(tinyrefl::fields<my_namespace::MyClass>().size(), 4);
+EXPECT_EQ(tinyrefl::fields<my_namespace::MyClass>()[1].name, "str");
+
+// Class layouts (members.hpp is generated with --layout)
+#ifdef TINYREFL_TEST_LAYOUT
+EXPECT_TRUE(tinyrefl::has_layout<foo::Foo>());
+EXPECT_FALSE(tinyrefl::has_layout<my_namespace::MyClass>());
+EXPECT_FALSE(tinyrefl::has_layout<my_namespace::MyClass::Enum>());
+EXPECT_EQ(tinyrefl::layout<foo::Foo>::size, sizeof(foo::Foo));
+EXPECT_EQ(tinyrefl::layout<foo::Foo>::alignment, alignof(foo::Foo));
+EXPECT_EQ(tinyrefl::layout<foo::Foo>::members::size, 1);
+EXPECT_TRUE(
+    (std::is_same<
+        tinyrefl::meta::get_t<0, tinyrefl::layout<foo::Foo>::members>::pointer,
+        ::ctti::static_value<int foo::Foo::*, &foo::Foo::member>>::value));
+EXPECT_EQ(
+    (tinyrefl::meta::get_t<0, tinyrefl::layout<foo::Foo>::members>::offset),
+    offsetof(foo::Foo, member));
+EXPECT_EQ(
+    (tinyrefl::meta::get_t<0, tinyrefl::layout<foo::Foo>::members>::size),
+    sizeof(int));
+EXPECT_EQ(tinyrefl::layout<foo::Foo>::fields[0].alignment, alignof(int));
+EXPECT_EQ(tinyrefl::layout<foo::Foo>::padding, 0);
+EXPECT_TRUE(tinyrefl::layout<foo::Foo>::unique_object_representations);
+#endif // TINYREFL_TEST_LAYOUT
+
+// Entity IDs (members.hpp is generated with the tinyrefl-test-static ID map)
+EXPECT_TRUE(tinyrefl::has_entity_id<foo::Foo>());
+EXPECT_TRUE(tinyrefl::has_entity_id<"foo::Foo::member"_id>());
+EXPECT_FALSE(tinyrefl::has_entity_id<my_namespace::MyClass>());
+EXPECT_FALSE(tinyrefl::has_entity_id<"foo::Foo::g"_id>());
+EXPECT_EQ(
+    tinyrefl::entity_id<foo::Foo>(), tinyrefl::entity_id<"foo::Foo"_id>());
+EXPECT_EQ(
+    tinyrefl::entity_id(tinyrefl::metadata<foo::Foo>()),
+    tinyrefl::entity_id<foo::Foo>());
+EXPECT_NE(
+    tinyrefl::entity_id<foo::Foo>(),
+    tinyrefl::entity_id<"foo::Foo::member"_id>());
+
+// Enum names are looked up through a constexpr hash index
+EXPECT_EQ(
+    tinyrefl::enum_cast<my_namespace::MyClass::Enum>("A"),
+    my_namespace::MyClass::Enum::A);
+EXPECT_EQ(
+    tinyrefl::enum_cast_case_insensitive<my_namespace::MyClass::Enum>("d"),
+    my_namespace::MyClass::Enum::D);
+EXPECT_FALSE(tinyrefl::metadata<my_namespace::MyClass::Enum>()
+                 .is_enumerated_value("d"));
+EXPECT_TRUE(tinyrefl::metadata<my_namespace::MyClass::Enum>()
+                .is_enumerated_value_case_insensitive("d"));
+
+// Enum values (A = 0 to D = 42) are too sparse to be direct indexed
+EXPECT_FALSE(tinyrefl::backend::enum_value_index<
+             tinyrefl::metadata<my_namespace::MyClass::Enum>>::dense);
+EXPECT_EQ(tinyrefl::to_string(my_namespace::MyClass::Enum::D), "D");
+EXPECT_EQ(tinyrefl::underlying_value(my_namespace::MyClass::Enum::D), 42);
+EXPECT_FALSE(tinyrefl::metadata<my_namespace::MyClass::Enum>()
+                 .is_enumerated_value(41));
+
+// Enum values are stored compactly, with names in one character array
+EXPECT_EQ(
+    sizeof(tinyrefl::metadata<my_namespace::MyClass::Enum>::value_t),
+    sizeof(my_namespace::MyClass::Enum) + sizeof(std::uint32_t));
+EXPECT_EQ(
+    tinyrefl::metadata<my_namespace::MyClass::Enum>::value_names[0], "A");
+EXPECT_EQ(
+    tinyrefl::metadata<my_namespace::MyClass::Enum>::value_names[3], "D");
+EXPECT_EQ(
+    tinyrefl::metadata<my_namespace::MyClass::Enum>::value_names[0]
+        .begin()[1],
+    '\0');
+EXPECT_EQ(
+    tinyrefl::metadata<my_namespace::MyClass::Enum>::invalid_value.name(),
+    "invalid enum value");
+
+// Runtime type registry
+constexpr tinyrefl::type_registry registry =
+    tinyrefl::make_type_registry_from_entities();
+
+constexpr bool all_types_found(const tinyrefl::type_registry& registry)
+{
+    for(const tinyrefl::type_descriptor& type : registry.types())
+    {
+        if(registry.find(type.hash) != &type ||
+           registry.find(type.name) != &type)
+        {
+            return false;
+        }
+    }
+
+    return registry.types().size() > 0;
+}
+
+EXPECT_TRUE(all_types_found(registry));
+EXPECT_EQ(
+    registry.find("my_namespace::MyClass"_id)->size,
+    sizeof(my_namespace::MyClass));
+EXPECT_EQ(
+    registry.find(ctti::detail::cstring{"my_namespace::MyClass"})
+        ->fields.size(),
+    4);
+EXPECT_TRUE(registry.find("my_namespace::MyClass::Enum"_id) == nullptr);
+EXPECT_TRUE(registry.find("not::a::Class"_id) == nullptr);
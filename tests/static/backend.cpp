@@ -61,3 +61,202 @@ EXPECT_EQ(
         tinyrefl::backend::string_constant<TINYREFL_STRING(hello::world)>()}
         .name(),
     "world");
+
+// Strings stored in a string pool
+struct pool
+{
+    static constexpr ctti::detail::cstring chars()
+    {
+        return {"hello\0"
+                "foo::bar\0",
+                15};
+    }
+};
+
+using pooled_hello  = tinyrefl::backend::pooled_string<pool, 0, 5>;
+using pooled_foobar = tinyrefl::backend::pooled_string<pool, 6, 8>;
+using pooled_empty  = tinyrefl::backend::pooled_string<pool, 5, 0>;
+
+EXPECT_EQ(tinyrefl::backend::string_constant<pooled_hello>(), "hello");
+EXPECT_EQ(tinyrefl::backend::string_constant<pooled_foobar>(), "foo::bar");
+EXPECT_EQ(
+    ctti::name_t{tinyrefl::backend::string_constant<pooled_foobar>()}.name(),
+    "bar");
+
+// Attribute lookup by name hash
+using hello_attribute = tinyrefl::backend::attribute_metadata<
+    pooled_hello,
+    pooled_empty,
+    pooled_hello,
+    tinyrefl::meta::list<>>;
+using foobar_attribute = tinyrefl::backend::attribute_metadata<
+    pooled_foobar,
+    pooled_empty,
+    pooled_foobar,
+    tinyrefl::meta::list<>>;
+using attributes = tinyrefl::backend::metadata_with_attributes<
+    tinyrefl::meta::list<hello_attribute, foobar_attribute>>;
+
+EXPECT_EQ(
+    attributes::get_attribute_hashes()[1],
+    ctti::detail::cstring{"foo::bar"}.hash());
+EXPECT_TRUE(attributes{}.has_attribute("hello"));
+EXPECT_TRUE(attributes{}.has_attribute("foo::bar"));
+EXPECT_FALSE(attributes{}.has_attribute("bar"));
+EXPECT_FALSE(attributes{}.has_attribute(""));
+EXPECT_EQ(attributes{}.get_attribute("foo::bar").full_attribute, "foo::bar");
+
+// Static tables, with a sentinel element at the end
+struct size_of
+{
+    template<typename T>
+    static constexpr std::size_t element()
+    {
+        return sizeof(T);
+    }
+
+    static constexpr std::size_t sentinel()
+    {
+        return 0;
+    }
+};
+
+using sizes_table = tinyrefl::backend::
+    static_table<std::size_t, size_of, tinyrefl::meta::list<char, int>>;
+using empty_table = tinyrefl::backend::
+    static_table<std::size_t, size_of, tinyrefl::meta::list<>>;
+
+EXPECT_EQ(sizes_table::count, 2);
+EXPECT_EQ(sizes_table::values[1], sizeof(int));
+EXPECT_EQ(sizes_table::values[2], 0);
+EXPECT_EQ(empty_table::count, 0);
+EXPECT_EQ(empty_table::values[0], 0);
+
+// Value indices of enum_ metadata
+struct indexed_value
+{
+    long long value;
+
+    constexpr long long underlying_value() const
+    {
+        return value;
+    }
+};
+
+constexpr std::array<indexed_value, 4> dense_values = {{{3}, {5}, {4}, {5}}};
+constexpr tinyrefl::backend::value_offset_index<long long, 3> dense_index{
+    dense_values};
+EXPECT_EQ(dense_index.find(3), 0);
+EXPECT_EQ(dense_index.find(4), 2);
+EXPECT_EQ(dense_index.find(5), 1);
+EXPECT_EQ(dense_index.find(2), -1);
+EXPECT_EQ(dense_index.find(6), -1);
+
+constexpr std::array<indexed_value, 5> sparse_values = {
+    {{1000}, {-5}, {42}, {42}, {-9223372036854775807ll}}};
+constexpr tinyrefl::backend::value_sorted_index<long long, 5> sparse_index{
+    sparse_values};
+EXPECT_EQ(sparse_index.find(1000), 0);
+EXPECT_EQ(sparse_index.find(-5), 1);
+EXPECT_EQ(sparse_index.find(42), 2);
+EXPECT_EQ(sparse_index.find(-9223372036854775807ll), 4);
+EXPECT_EQ(sparse_index.find(0), -1);
+EXPECT_EQ(sparse_index.find(2000), -1);
+
+// Value domains for bulk validation
+struct sparse_enum
+{
+    using underlying_type = long long;
+    using values          = tinyrefl::meta::list<void, void, void, void, void>;
+
+    static constexpr std::array<indexed_value, 5> enum_values = sparse_values;
+};
+
+constexpr std::array<indexed_value, 5> sparse_enum::enum_values;
+
+EXPECT_FALSE(tinyrefl::backend::enum_value_index<sparse_enum>::dense);
+EXPECT_TRUE(tinyrefl::backend::enum_value_domain<sparse_enum>::contains(42));
+EXPECT_TRUE(tinyrefl::backend::enum_value_domain<sparse_enum>::contains(
+    -9223372036854775807ll));
+EXPECT_FALSE(tinyrefl::backend::enum_value_domain<sparse_enum>::contains(43));
+
+constexpr tinyrefl::backend::value_bitmap<long long, 3> dense_bitmap{
+    dense_values};
+EXPECT_TRUE(dense_bitmap.contains(3));
+EXPECT_TRUE(dense_bitmap.contains(5));
+EXPECT_FALSE(dense_bitmap.contains(2));
+EXPECT_FALSE(dense_bitmap.contains(6));
+
+// Layout descriptors
+struct padded
+{
+    char c;
+    int  i;
+};
+
+struct packed
+{
+    int   i;
+    short s[2];
+};
+
+struct with_padded_member
+{
+    padded p;
+};
+
+namespace tinyrefl
+{
+namespace backend
+{
+template<>
+struct layout_of<padded>
+{
+    using type = class_layout<
+        sizeof(padded),
+        alignof(padded),
+        tinyrefl::meta::list<
+            member_layout<CTTI_STATIC_VALUE(&padded::c), 0, 1>,
+            member_layout<CTTI_STATIC_VALUE(&padded::i), 4, 4>>>;
+};
+
+template<>
+struct layout_of<packed>
+{
+    using type = class_layout<
+        sizeof(packed),
+        alignof(packed),
+        tinyrefl::meta::list<
+            member_layout<CTTI_STATIC_VALUE(&packed::i), 0, 4>,
+            member_layout<CTTI_STATIC_VALUE(&packed::s), 4, 4>>>;
+};
+
+template<>
+struct layout_of<with_padded_member>
+{
+    using type = class_layout<
+        sizeof(with_padded_member),
+        alignof(with_padded_member),
+        tinyrefl::meta::list<
+            member_layout<CTTI_STATIC_VALUE(&with_padded_member::p), 0, 8>>>;
+};
+} // namespace backend
+} // namespace tinyrefl
+
+using padded_layout = tinyrefl::backend::layout_of_type<padded>;
+using packed_layout = tinyrefl::backend::layout_of_type<packed>;
+
+EXPECT_EQ(padded_layout::field_count, 2);
+EXPECT_EQ(padded_layout::fields[1].offset, 4);
+EXPECT_EQ(padded_layout::fields[1].size, 4);
+EXPECT_EQ(padded_layout::fields[1].alignment, alignof(int));
+EXPECT_EQ(padded_layout::fields[0].alignment, 1);
+EXPECT_EQ(padded_layout::padding, 3);
+EXPECT_FALSE(padded_layout::unique_object_representations);
+EXPECT_EQ(packed_layout::padding, 0);
+EXPECT_EQ(packed_layout::fields[1].alignment, alignof(short));
+EXPECT_TRUE(packed_layout::unique_object_representations);
+EXPECT_FALSE(tinyrefl::backend::layout_of_type<
+             with_padded_member>::unique_object_representations);
+EXPECT_EQ(
+    tinyrefl::backend::layout_of_type<with_padded_member>::padding, 0);
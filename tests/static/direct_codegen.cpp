@@ -0,0 +1,121 @@
+#include "direct_codegen.hpp"
+#include "members.hpp"
+#include <tinyrefl/api.hpp>
+#include "direct_codegen.hpp.tinyrefl"
+#include "members.hpp.tinyrefl"
+#include CTTI_STATIC_TESTS_HEADER
+
+// direct_codegen.hpp is processed with tinyrefl-tool --direct-codegen, the
+// metadata it generates must be the same the macro backend would give, and
+// must be usable together with macro based codegen in the same TU
+
+#if TINYREFL_GENERATED_FILE_COUNT != 2
+#error "Expected two tinyrefl codegen headers"
+#endif
+
+using namespace tinyrefl::literals;
+
+EXPECT_TRUE(tinyrefl::has_metadata<direct_codegen::Foo>());
+EXPECT_TRUE(tinyrefl::has_metadata<direct_codegen::Foo::Enum>());
+EXPECT_TRUE(tinyrefl::has_metadata<foo::Foo>());
+
+EXPECT_EQ(
+    tinyrefl::metadata<direct_codegen::Foo>::name.full_name(),
+    "direct_codegen::Foo");
+EXPECT_TRUE(tinyrefl::has_entity_metadata<"direct_codegen::Foo"_id>());
+EXPECT_TRUE((std::is_same<
+             tinyrefl::entity_metadata<"direct_codegen::Foo"_id>,
+             tinyrefl::metadata<direct_codegen::Foo>>::value));
+
+EXPECT_TRUE(tinyrefl::has_attribute<direct_codegen::Foo>("direct_codegen"));
+EXPECT_EQ(
+    tinyrefl::metadata<direct_codegen::Foo>()
+        .get_attribute("direct_codegen")
+        .args.size(),
+    3);
+
+#ifdef TINYREFL_HAS_CONSTEXPR_ARRAY_VIEW_SUBSCRIPT
+EXPECT_EQ(
+    tinyrefl::metadata<direct_codegen::Foo>()
+        .get_attribute("direct_codegen")
+        .args[0],
+    "\"hello world\"");
+EXPECT_EQ(
+    tinyrefl::metadata<direct_codegen::Foo>()
+        .get_attribute("direct_codegen")
+        .args[2],
+    "42");
+EXPECT_EQ(
+    tinyrefl::metadata<direct_codegen::Foo>()
+        .get_attribute("direct_codegen")
+        .full_attribute,
+    "direct_codegen(\"hello world\",42)");
+#endif // TINYREFL_HAS_CONSTEXPR_ARRAY_VIEW_SUBSCRIPT
+
+EXPECT_EQ(tinyrefl::metadata<direct_codegen::Foo>::constructors::size, 2);
+EXPECT_TRUE((std::is_same<
+             tinyrefl::meta::get_t<
+                 1,
+                 tinyrefl::metadata<direct_codegen::Foo>::constructors>::args,
+             tinyrefl::meta::list<int>>::value));
+
+EXPECT_EQ(tinyrefl::metadata<direct_codegen::Foo>::member_variables::size, 1);
+EXPECT_TRUE(tinyrefl::has_entity_metadata<"direct_codegen::Foo::member"_id>());
+EXPECT_TRUE((std::is_same<
+             tinyrefl::entity_metadata<"direct_codegen::Foo::member"_id>,
+             tinyrefl::metadata<::ctti::static_value<
+                 int direct_codegen::Foo::*,
+                 &direct_codegen::Foo::member>>>::value));
+
+EXPECT_TRUE(
+    tinyrefl::has_entity_metadata<"direct_codegen::Foo::f(int) const"_id>());
+EXPECT_TRUE((std::is_same<
+             tinyrefl::entity_metadata<"direct_codegen::Foo::f(int) const"_id>,
+             tinyrefl::metadata<::ctti::static_value<
+                 void (direct_codegen::Foo::*)(int) const,
+                 &direct_codegen::Foo::f>>>::value));
+EXPECT_EQ(
+    tinyrefl::entity_metadata<"direct_codegen::Foo::f(int) const"_id>::
+        arg_names[0],
+    "arg");
+
+EXPECT_EQ(
+    tinyrefl::metadata<direct_codegen::Foo::Enum>().get_value("B").value(),
+    direct_codegen::Foo::Enum::B);
+EXPECT_EQ(
+    tinyrefl::metadata<direct_codegen::Foo::Enum>().get_value(42).name(),
+    "B");
+EXPECT_TRUE(tinyrefl::has_entity_metadata<"direct_codegen::Foo::Enum::B"_id>());
+
+// Strings shared with members.hpp ("member", "f", ...) are defined once
+EXPECT_TRUE(tinyrefl::has_entity_metadata<"foo::Foo::member"_id>());
+EXPECT_EQ(tinyrefl::metadata<foo::Foo>::member_variables::size, 1);
+
+// Direct codegen emits class layouts too
+#ifdef TINYREFL_TEST_LAYOUT
+EXPECT_TRUE(tinyrefl::has_layout<direct_codegen::Foo>());
+EXPECT_EQ(
+    tinyrefl::layout<direct_codegen::Foo>::size, sizeof(direct_codegen::Foo));
+EXPECT_TRUE((std::is_same<
+             tinyrefl::meta::get_t<
+                 0,
+                 tinyrefl::layout<direct_codegen::Foo>::members>::pointer,
+             ::ctti::static_value<
+                 int direct_codegen::Foo::*,
+                 &direct_codegen::Foo::member>>::value));
+#endif // TINYREFL_TEST_LAYOUT
+
+// Direct codegen assigns entity IDs from the ID map shared with the macro
+// based codegen of members.hpp
+EXPECT_TRUE(tinyrefl::has_entity_id<direct_codegen::Foo>());
+EXPECT_TRUE(tinyrefl::has_entity_id<direct_codegen::Foo::Enum>());
+EXPECT_EQ(
+    tinyrefl::entity_id(
+        tinyrefl::entity_metadata<"direct_codegen::Foo::Enum::B"_id>()),
+    tinyrefl::entity_id<"direct_codegen::Foo::Enum::B"_id>());
+EXPECT_NE(
+    tinyrefl::entity_id<foo::Foo>(),
+    tinyrefl::entity_id<direct_codegen::Foo>());
+EXPECT_NE(
+    tinyrefl::entity_id<"foo::Foo::member"_id>(),
+    tinyrefl::entity_id<"direct_codegen::Foo::member"_id>());
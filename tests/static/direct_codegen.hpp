@@ -0,0 +1,18 @@
+namespace direct_codegen
+{
+struct [[direct_codegen("hello world", 42)]] Foo
+{
+    Foo() = default;
+    Foo(int member) : member{member} {}
+
+    int member = 0;
+
+    void f(int arg) const {}
+
+    enum class Enum
+    {
+        A,
+        B = 42
+    };
+};
+} // namespace direct_codegen
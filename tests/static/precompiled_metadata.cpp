@@ -0,0 +1,13 @@
+#include CTTI_STATIC_TESTS_HEADER
+
+// tinyrefl_tool(... PRECOMPILE_METADATA PRECOMPILE_SOURCES) force includes
+// the precompiled metadata header of the target in this source file only, so
+// the API and the metadata are available with no includes
+
+#ifndef TINYREFL_API_HPP
+#error "Expected the precompiled tinyrefl metadata header"
+#endif
+
+EXPECT_TRUE(tinyrefl::has_metadata<precompiled_metadata::A>());
+EXPECT_EQ(
+    tinyrefl::metadata<precompiled_metadata::A>::member_variables::size, 2);
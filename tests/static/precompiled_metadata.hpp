@@ -0,0 +1,8 @@
+namespace precompiled_metadata
+{
+struct A
+{
+    int a;
+    int b;
+};
+} // namespace precompiled_metadata
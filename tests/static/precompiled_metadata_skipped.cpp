@@ -0,0 +1,6 @@
+// Sources of the target not listed in PRECOMPILE_SOURCES are compiled without
+// the precompiled metadata header, even if added after tinyrefl_tool()
+
+#ifdef TINYREFL_API_HPP
+#error "Unexpected precompiled tinyrefl metadata header"
+#endif
@@ -0,0 +1,18 @@
+#include "sharded_codegen.hpp"
+#include <tinyrefl/api.hpp>
+#include "sharded_codegen.hpp.sharded_codegen.A.tinyrefl"
+#include CTTI_STATIC_TESTS_HEADER
+
+// sharded_codegen.hpp is processed with tinyrefl-tool --sharded-codegen,
+// so the metadata of each top level class and enum can be included alone.
+// Shards are not part of the global metadata list, the umbrella file lists
+// the entities of all of them (See sharded_codegen_umbrella.cpp)
+
+#ifdef TINYREFL_GENERATED_FILE_COUNT
+#error "Shards must not count as tinyrefl codegen headers"
+#endif
+
+EXPECT_TRUE(tinyrefl::has_metadata<sharded_codegen::A>());
+EXPECT_FALSE(tinyrefl::has_metadata<sharded_codegen::B>());
+EXPECT_FALSE(tinyrefl::has_metadata<sharded_codegen::B::Enum>());
+EXPECT_FALSE(tinyrefl::has_metadata<sharded_codegen::Enum>());
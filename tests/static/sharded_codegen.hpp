@@ -0,0 +1,22 @@
+namespace sharded_codegen
+{
+struct A
+{
+    int a;
+};
+
+struct B
+{
+    enum class Enum
+    {
+        X
+    };
+
+    int b;
+};
+
+enum class Enum
+{
+    Y
+};
+} // namespace sharded_codegen
@@ -0,0 +1,16 @@
+#include "sharded_codegen.hpp"
+#include <tinyrefl/api.hpp>
+#include "sharded_codegen.hpp.tinyrefl"
+#include CTTI_STATIC_TESTS_HEADER
+
+// The umbrella file of a sharded header is one entry of the global
+// metadata list, no matter how many shards it includes
+
+#if TINYREFL_GENERATED_FILE_COUNT != 1
+#error "Expected one tinyrefl codegen header"
+#endif
+
+EXPECT_TRUE(tinyrefl::has_metadata<sharded_codegen::A>());
+EXPECT_TRUE(tinyrefl::has_metadata<sharded_codegen::B>());
+EXPECT_TRUE(tinyrefl::has_metadata<sharded_codegen::B::Enum>());
+EXPECT_TRUE(tinyrefl::has_metadata<sharded_codegen::Enum>());
@@ -0,0 +1,12 @@
+namespace sharded_umbrella
+{
+struct A
+{
+    int a;
+};
+
+struct B
+{
+    int b;
+};
+} // namespace sharded_umbrella
@@ -0,0 +1,18 @@
+# The umbrella file of a sharded header must be newer than the header after
+# a run, even if its contents did not change, or the header is parsed again
+# in every build
+include("${CMAKE_CURRENT_LIST_DIR}/tool_test.cmake")
+
+copy_fixtures(sharded_umbrella.hpp)
+run_tool(output sharded_umbrella.hpp --sharded-codegen)
+expect_in("${output}" "Metadata of sharded_umbrella::B saved in")
+
+# Only the shard of B changes, the umbrella still includes the same shards
+edit_file(sharded_umbrella.hpp "int b;" "int b, c;")
+run_tool(output sharded_umbrella.hpp --sharded-codegen)
+expect_in("${output}" "Metadata of sharded_umbrella::A is up to date")
+expect_in("${output}" "Metadata of sharded_umbrella::B saved in")
+
+run_tool(output sharded_umbrella.hpp --sharded-codegen)
+expect_in("${output}" "metadata is up to date, skipping")
+expect_not_in("${output}" "saved in")
@@ -0,0 +1,7 @@
+namespace single_tu
+{
+struct A
+{
+    int a;
+};
+} // namespace single_tu
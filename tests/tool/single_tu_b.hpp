@@ -0,0 +1,7 @@
+namespace single_tu
+{
+struct B
+{
+    int b;
+};
+} // namespace single_tu
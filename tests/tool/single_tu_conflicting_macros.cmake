@@ -0,0 +1,18 @@
+# A macro defined by a header must not reach the headers after it: The
+# second header only defines its member name if not defined yet
+include("${CMAKE_CURRENT_LIST_DIR}/tool_test.cmake")
+
+copy_fixtures(single_tu_first.hpp single_tu_second.hpp single_tu_third.hpp)
+run_tool(output single_tu_first.hpp single_tu_second.hpp single_tu_third.hpp)
+expect_in("${output}" "parsing file single_tu_first.hpp")
+expect_in("${output}" "parsing 2 files in one synthetic translation unit: single_tu_second.hpp, single_tu_third.hpp")
+
+read_file(single_tu_first.hpp.tinyrefl metadata)
+expect_in("${metadata}" "single_tu::First::first_member")
+
+read_file(single_tu_second.hpp.tinyrefl metadata)
+expect_in("${metadata}" "single_tu::Second::second_member")
+expect_not_in("${metadata}" "first_member")
+
+read_file(single_tu_third.hpp.tinyrefl metadata)
+expect_in("${metadata}" "single_tu::Third::third_member")
@@ -0,0 +1,12 @@
+# Diagnostics of the synthetic translation unit are reported at the file and
+# line of the original header, not the synthetic translation unit
+include("${CMAKE_CURRENT_LIST_DIR}/tool_test.cmake")
+
+copy_fixtures(single_tu_a.hpp single_tu_diagnostic.hpp)
+run_tool(output single_tu_a.hpp single_tu_diagnostic.hpp)
+expect_in("${output}" "parsing 2 files in one synthetic translation unit")
+
+# Line 7 of single_tu_diagnostic.hpp uses a deprecated class
+expect_in("${output}" "single_tu_diagnostic.hpp:7")
+expect_in("${output}" "deprecated")
+expect_not_in("${output}" "tinyrefl-tool-synthetic-tu")
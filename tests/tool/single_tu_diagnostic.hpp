@@ -0,0 +1,8 @@
+namespace single_tu
+{
+struct [[deprecated]] Deprecated
+{
+};
+
+using NotDeprecated = Deprecated;
+} // namespace single_tu
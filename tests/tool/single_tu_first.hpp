@@ -0,0 +1,9 @@
+#define SINGLE_TU_MEMBER first_member
+
+namespace single_tu
+{
+struct First
+{
+    int SINGLE_TU_MEMBER;
+};
+} // namespace single_tu
@@ -0,0 +1,22 @@
+# Headers defining macros are parsed on their own, the rest of the headers
+# of the run share one synthetic translation unit
+include("${CMAKE_CURRENT_LIST_DIR}/tool_test.cmake")
+
+copy_fixtures(single_tu_a.hpp single_tu_leaky.hpp single_tu_b.hpp)
+run_tool(output single_tu_a.hpp single_tu_leaky.hpp single_tu_b.hpp)
+expect_in("${output}" "parsing 2 files in one synthetic translation unit: single_tu_a.hpp, single_tu_b.hpp")
+expect_in("${output}" "parsing file single_tu_leaky.hpp")
+
+# Each header only gets the entities declared in it
+read_file(single_tu_a.hpp.tinyrefl metadata)
+expect_in("${metadata}" "single_tu::A::a")
+expect_not_in("${metadata}" "single_tu::B")
+expect_not_in("${metadata}" "single_tu::Leaky")
+
+read_file(single_tu_b.hpp.tinyrefl metadata)
+expect_in("${metadata}" "single_tu::B::b")
+expect_not_in("${metadata}" "single_tu::A")
+expect_not_in("${metadata}" "single_tu::Leaky")
+
+read_file(single_tu_leaky.hpp.tinyrefl metadata)
+expect_in("${metadata}" "single_tu::Leaky::leaky")
@@ -0,0 +1,10 @@
+// Defines a macro, which would change the parsing of the headers after it
+#define SINGLE_TU_LEAKY_MEMBER leaky
+
+namespace single_tu
+{
+struct Leaky
+{
+    int SINGLE_TU_LEAKY_MEMBER;
+};
+} // namespace single_tu
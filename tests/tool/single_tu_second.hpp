@@ -0,0 +1,11 @@
+#ifndef SINGLE_TU_MEMBER
+#define SINGLE_TU_MEMBER second_member
+#endif
+
+namespace single_tu
+{
+struct Second
+{
+    int SINGLE_TU_MEMBER;
+};
+} // namespace single_tu
@@ -0,0 +1,7 @@
+namespace single_tu
+{
+struct Third
+{
+    int third_member;
+};
+} // namespace single_tu
@@ -0,0 +1,66 @@
+# Common code of the tool test scripts, see add_tinyrefl_tool_test()
+
+set(fixtures_dir "${CMAKE_CURRENT_LIST_DIR}")
+
+file(REMOVE_RECURSE "${WORK_DIR}")
+file(MAKE_DIRECTORY "${WORK_DIR}")
+
+# Copies fixture headers to the work directory
+function(copy_fixtures)
+    foreach(fixture ${ARGN})
+        configure_file("${fixtures_dir}/${fixture}" "${WORK_DIR}/${fixture}" COPYONLY)
+    endforeach()
+endfunction()
+
+# Runs the tool from the work directory, failing the test if the tool
+# fails. Stores the output (stdout and stderr) in OUTPUT
+function(run_tool OUTPUT)
+    if(CLANG_BINARY)
+        set(clang_binary_option "--clang-binary=${CLANG_BINARY}")
+    endif()
+
+    execute_process(
+        COMMAND "${TINYREFL_TOOL}" ${ARGN} ${clang_binary_option} -std=c++${CXX_STANDARD}
+        WORKING_DIRECTORY "${WORK_DIR}"
+        OUTPUT_VARIABLE output
+        ERROR_VARIABLE output
+        RESULT_VARIABLE result
+    )
+
+    if(NOT result EQUAL 0)
+        message(FATAL_ERROR "tinyrefl-tool ${ARGN} failed (${result}):\n${output}")
+    endif()
+
+    set(${OUTPUT} "${output}" PARENT_SCOPE)
+endfunction()
+
+function(expect_in OUTPUT TEXT)
+    string(FIND "${OUTPUT}" "${TEXT}" index)
+
+    if(index EQUAL -1)
+        message(FATAL_ERROR "Expected \"${TEXT}\" in:\n${OUTPUT}")
+    endif()
+endfunction()
+
+function(expect_not_in OUTPUT TEXT)
+    string(FIND "${OUTPUT}" "${TEXT}" index)
+
+    if(NOT index EQUAL -1)
+        message(FATAL_ERROR "Unexpected \"${TEXT}\" in:\n${OUTPUT}")
+    endif()
+endfunction()
+
+# Reads a file of the work directory into OUTPUT
+function(read_file FILE OUTPUT)
+    file(READ "${WORK_DIR}/${FILE}" contents)
+    set(${OUTPUT} "${contents}" PARENT_SCOPE)
+endfunction()
+
+# Replaces text in a file of the work directory. Waits first so the edit
+# gets a newer timestamp than the files generated before
+function(edit_file FILE FROM TO)
+    execute_process(COMMAND "${CMAKE_COMMAND}" -E sleep 2)
+    file(READ "${WORK_DIR}/${FILE}" contents)
+    string(REPLACE "${FROM}" "${TO}" contents "${contents}")
+    file(WRITE "${WORK_DIR}/${FILE}" "${contents}")
+endfunction()
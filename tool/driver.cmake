@@ -3,9 +3,9 @@ include(${TINYREFL_SOURCE_DIR}/cmake/utils.cmake)
 function(tinyrefl_tool)
     cmake_parse_arguments(
         ARGS
-        ""
-        "TARGET"
-        "HEADERS;COMPILE_OPTIONS;COMPILE_DEFINITIONS"
+        "DIRECT_CODEGEN;SHARDED_CODEGEN;PRECOMPILE_METADATA;HEADER_UNIT;SINGLE_TU;LAYOUT;ENTITY_IDS"
+        "TARGET;ID_MAP"
+        "HEADERS;COMPILE_OPTIONS;COMPILE_DEFINITIONS;PRECOMPILE_SOURCES"
         ${ARGN}
     )
 
@@ -76,11 +76,44 @@ function(tinyrefl_tool)
         set(clang_executable_option "--clang-binary=\"${TINYREFL_TOOL_CLANGPP_EXECUTABLE}\"")
     endif()
 
+    if(ARGS_DIRECT_CODEGEN)
+        list(APPEND codegen_options "--direct-codegen")
+    endif()
+    if(ARGS_SHARDED_CODEGEN)
+        list(APPEND codegen_options "--sharded-codegen")
+    endif()
+    if(ARGS_LAYOUT)
+        if(DEFINED TINYREFL_TOOL_HAS_LIBCLANG AND NOT TINYREFL_TOOL_HAS_LIBCLANG)
+            message(FATAL_ERROR "tinyrefl_tool(TARGET ${ARGS_TARGET} LAYOUT): tinyrefl-tool was built without libclang, class layouts are not available")
+        endif()
+
+        list(APPEND codegen_options "--layout")
+    endif()
+
+    # All the calls for a target share its ID map, so entity IDs are unique
+    # in the target. The default map is a build artifact, pass ID_MAP with a
+    # path in the source tree to commit it
+    if(ARGS_ENTITY_IDS AND NOT ARGS_ID_MAP)
+        set(ARGS_ID_MAP "${CMAKE_CURRENT_BINARY_DIR}/${ARGS_TARGET}.tinyrefl_ids")
+    endif()
+    if(ARGS_ID_MAP)
+        get_filename_component(id_map "${ARGS_ID_MAP}" ABSOLUTE BASE_DIR "${CMAKE_CURRENT_SOURCE_DIR}")
+        get_target_property(target_id_map ${ARGS_TARGET} TINYREFL_ID_MAP)
+
+        if(target_id_map AND NOT (target_id_map STREQUAL id_map))
+            message(FATAL_ERROR "tinyrefl_tool() calls on ${ARGS_TARGET} must use the same ID map (Got ${id_map}, previous calls use ${target_id_map})")
+        endif()
+
+        set_property(TARGET ${ARGS_TARGET} PROPERTY TINYREFL_ID_MAP "${id_map}")
+        list(APPEND codegen_options "--id-map=${id_map}")
+    endif()
+
     string(REGEX REPLACE ";" " " header_list "${ARGS_HEADERS}")
     string(REGEX REPLACE ";" " " includes_list "${includes}")
     string(REGEX REPLACE ";" " " options_list "${compile_options}")
     string(REGEX REPLACE ";" " " definitions_list "${definitions}")
-    message(STATUS ">> Tinyrefl driver on ${ARGS_TARGET}: tinyrefl ${header_list} -std=c++${CMAKE_CXX_STANDARD} ${definitions_list} ${includes_list} ${options_list}")
+    string(REGEX REPLACE ";" " " codegen_options_list "${codegen_options}")
+    message(STATUS ">> Tinyrefl driver on ${ARGS_TARGET}: tinyrefl ${header_list} ${codegen_options_list} -std=c++${CMAKE_CXX_STANDARD} ${definitions_list} ${includes_list} ${options_list}")
 
     if(NOT TARGET clean-tinyrefl)
         add_custom_target(clean-tinyrefl)
@@ -98,13 +131,276 @@ function(tinyrefl_tool)
 
         add_dependencies(clean-tinyrefl ${clean_target})
 
+        if(NOT ARGS_SINGLE_TU)
+            add_prebuild_command(TARGET ${ARGS_TARGET}
+                NAME "${command_target_name}"
+                COMMAND ${TINYREFL_TOOL_EXECUTABLE} ${header} ${clang_executable_option} ${codegen_options} -std=c++${CMAKE_CXX_STANDARD} ${definitions} ${includes} ${compile_options}
+                WORKING_DIRECTORY ${CMAKE_CURRENT_SOURCE_DIR}
+                COMMENT "Generating tinyrefl metadata for ${ARGS_TARGET}/${header}"
+                DEPENDS ${TINYREFL_TOOL_TARGET}
+            )
+
+            if(ARGS_ID_MAP)
+                tinyrefl_serialize_id_map_command(${ARGS_TARGET} ${command_target_name})
+            endif()
+        endif()
+    endforeach()
+
+    # Parse all the headers at once, from one synthetic translation unit
+    if(ARGS_SINGLE_TU)
+        string(MD5 headers_hash "${ARGS_HEADERS}")
+        set(command_target_name "tinyrefl_tool_${ARGS_TARGET}_${headers_hash}.tinyrefl")
+
         add_prebuild_command(TARGET ${ARGS_TARGET}
             NAME "${command_target_name}"
-            COMMAND ${TINYREFL_TOOL_EXECUTABLE} ${header} ${clang_executable_option} -std=c++${CMAKE_CXX_STANDARD} ${definitions} ${includes} ${compile_options}
+            COMMAND ${TINYREFL_TOOL_EXECUTABLE} ${ARGS_HEADERS} ${clang_executable_option} ${codegen_options} -std=c++${CMAKE_CXX_STANDARD} ${definitions} ${includes} ${compile_options}
             WORKING_DIRECTORY ${CMAKE_CURRENT_SOURCE_DIR}
-            COMMENT "Generating tinyrefl metadata for ${ARGS_TARGET}/${header}"
+            COMMENT "Generating tinyrefl metadata for ${ARGS_TARGET}/{${header_list}}"
             DEPENDS ${TINYREFL_TOOL_TARGET}
         )
+
+        if(ARGS_ID_MAP)
+            tinyrefl_serialize_id_map_command(${ARGS_TARGET} ${command_target_name})
+        endif()
+    endif()
+
+    if(ARGS_HEADER_UNIT)
+        set(header_unit HEADER_UNIT)
+    endif()
+    if(ARGS_PRECOMPILE_METADATA OR ARGS_HEADER_UNIT)
+        tinyrefl_metadata_header(TARGET ${ARGS_TARGET} ${header_unit} HEADERS ${ARGS_HEADERS} SOURCES ${ARGS_PRECOMPILE_SOURCES})
+    endif()
+endfunction()
+
+# Tool runs updating the same ID map must not run in parallel, chain each one
+# after the previous run for the target
+function(tinyrefl_serialize_id_map_command TARGET COMMAND_TARGET)
+    get_target_property(previous_command ${TARGET} TINYREFL_ID_MAP_COMMAND)
+
+    if(previous_command)
+        add_dependencies(${COMMAND_TARGET} ${previous_command})
+    endif()
+
+    set_property(TARGET ${TARGET} PROPERTY TINYREFL_ID_MAP_COMMAND ${COMMAND_TARGET})
+endfunction()
+
+# Aggregates the API and all the reflected headers of a target (with their
+# generated code) into one self-contained header,
+# ${CMAKE_CURRENT_BINARY_DIR}/<target>.tinyrefl.hpp, and precompiles it for
+# the given SOURCES of the target (Requires CMake >= 3.19). The precompiled
+# header is force included, so only the sources listed get it and the rest of
+# the target is compiled as is. With HEADER_UNIT the header is built as a C++20
+# header unit instead of a precompiled header, and the listed sources import it.
+# The header path is stored in the TINYREFL_METADATA_HEADER target property.
+function(tinyrefl_metadata_header)
+    cmake_parse_arguments(
+        ARGS
+        "HEADER_UNIT"
+        "TARGET"
+        "HEADERS;SOURCES"
+        ${ARGN}
+    )
+
+    if(NOT ARGS_SOURCES)
+        message(WARNING "No PRECOMPILE_SOURCES given for ${ARGS_TARGET}, the metadata header will not be precompiled for any source file")
+    endif()
+
+    foreach(header ${ARGS_HEADERS})
+        get_filename_component(header "${header}" ABSOLUTE BASE_DIR "${CMAKE_CURRENT_SOURCE_DIR}")
+        set_property(TARGET ${ARGS_TARGET} APPEND PROPERTY TINYREFL_METADATA_HEADERS "${header}")
+        set_property(TARGET ${ARGS_TARGET} APPEND PROPERTY TINYREFL_METADATA_INCLUDES
+            "#include \"${header}\""
+            "#include \"${header}.tinyrefl\""
+        )
+    endforeach()
+
+    foreach(source ${ARGS_SOURCES})
+        get_filename_component(source "${source}" ABSOLUTE BASE_DIR "${CMAKE_CURRENT_SOURCE_DIR}")
+        set_property(TARGET ${ARGS_TARGET} APPEND PROPERTY TINYREFL_METADATA_SOURCES "${source}")
     endforeach()
+
+    # All the calls share the same header
+    get_target_property(metadata_header ${ARGS_TARGET} TINYREFL_METADATA_HEADER)
+    get_target_property(header_unit ${ARGS_TARGET} TINYREFL_METADATA_HEADER_UNIT)
+
+    if(metadata_header)
+        if((header_unit AND NOT ARGS_HEADER_UNIT) OR (ARGS_HEADER_UNIT AND NOT header_unit))
+            message(FATAL_ERROR "tinyrefl_tool() calls on ${ARGS_TARGET} must all pass HEADER_UNIT or none of them")
+        endif()
+
+        return()
+    endif()
+
+    set(metadata_header "${CMAKE_CURRENT_BINARY_DIR}/${ARGS_TARGET}.tinyrefl.hpp")
+    string(MAKE_C_IDENTIFIER "TINYREFL_METADATA_HEADER_${ARGS_TARGET}" include_guard)
+    string(TOUPPER "${include_guard}" include_guard)
+    set_property(TARGET ${ARGS_TARGET} PROPERTY TINYREFL_METADATA_HEADER "${metadata_header}")
+
+    file(GENERATE OUTPUT "${metadata_header}" CONTENT
+"// Generated by tinyrefl_tool(), do not edit
+#ifndef ${include_guard}
+#define ${include_guard}
+
+#include <tinyrefl/api.hpp>
+
+$<JOIN:$<TARGET_PROPERTY:${ARGS_TARGET},TINYREFL_METADATA_INCLUDES>,
+>
+
+#endif // ${include_guard}
+")
+
+    if(CMAKE_VERSION VERSION_LESS 3.19)
+        message(STATUS ">> Tinyrefl driver on ${ARGS_TARGET}: metadata header ${metadata_header} not precompiled (Requires CMake >= 3.19)")
+        return()
+    endif()
+
+    if(ARGS_HEADER_UNIT)
+        message(STATUS ">> Tinyrefl driver on ${ARGS_TARGET}: building metadata header ${metadata_header} as a header unit")
+        tinyrefl_metadata_header_unit(${ARGS_TARGET} "${metadata_header}")
+    else()
+        message(STATUS ">> Tinyrefl driver on ${ARGS_TARGET}: precompiling metadata header ${metadata_header}")
+        target_precompile_headers(${ARGS_TARGET} PRIVATE "${metadata_header}")
+    endif()
+
+    # The sources of the target are only known once the directory is
+    # processed, so sources added after tinyrefl_tool() are handled too.
+    # Deferred call arguments are expanded when the call runs, not here
+    cmake_language(EVAL CODE "cmake_language(DEFER CALL tinyrefl_metadata_header_sources [[${ARGS_TARGET}]])")
 endfunction()
 
+# Builds the metadata header of a target as a C++20 header unit, with the
+# same flags the target sources are compiled with, and writes the import
+# declaration force included in the sources that use it. Header units are
+# built by the GCC (-fmodules-ts), Clang and MSVC compiler drivers.
+function(tinyrefl_metadata_header_unit TARGET HEADER)
+    get_target_property(standard ${TARGET} CXX_STANDARD)
+    get_target_property(extensions ${TARGET} CXX_EXTENSIONS)
+
+    if(NOT standard)
+        set(standard ${CMAKE_CXX_STANDARD})
+    endif()
+    if(NOT standard OR standard LESS 20 OR standard EQUAL 98)
+        message(FATAL_ERROR "tinyrefl_tool(TARGET ${TARGET} HEADER_UNIT): header units require C++20 or later (CXX_STANDARD is '${standard}')")
+    endif()
+    if(extensions MATCHES "NOTFOUND")
+        set(extensions ON)
+    endif()
+    if(extensions)
+        set(standard_option ${CMAKE_CXX${standard}_EXTENSION_COMPILE_OPTION})
+    else()
+        set(standard_option ${CMAKE_CXX${standard}_STANDARD_COMPILE_OPTION})
+    endif()
+
+    string(REGEX REPLACE " " ";" global_compile_options "${CMAKE_CXX_FLAGS}")
+
+    if(CMAKE_BUILD_TYPE MATCHES "Debug")
+        string(REGEX REPLACE " " ";" global_extra_compile_options "${CMAKE_CXX_FLAGS_DEBUG}")
+    else()
+        string(REGEX REPLACE " " ";" global_extra_compile_options "${CMAKE_CXX_FLAGS_RELEASE}")
+    endif()
+
+    # The header unit must be built with the flags of the sources importing
+    # it, usage requirements of the target dependencies included
+    set(includes "$<TARGET_PROPERTY:${TARGET},INCLUDE_DIRECTORIES>")
+    set(definitions "$<TARGET_PROPERTY:${TARGET},COMPILE_DEFINITIONS>")
+    set(compile_options
+        ${standard_option}
+        ${global_compile_options}
+        ${global_extra_compile_options}
+        "$<$<BOOL:${includes}>:-I$<JOIN:${includes},$<SEMICOLON>-I>>"
+        "$<$<BOOL:${definitions}>:-D$<JOIN:${definitions},$<SEMICOLON>-D>>"
+        "$<TARGET_PROPERTY:${TARGET},COMPILE_OPTIONS>"
+    )
+
+    set(header_unit "${CMAKE_CURRENT_BINARY_DIR}/${TARGET}.tinyrefl")
+    set(import_header "${header_unit}.import.hpp")
+
+    if(CMAKE_CXX_COMPILER_ID STREQUAL "GNU")
+        # GCC finds the header unit of an imported header in the module mapper
+        set(mapper "${header_unit}.mapper")
+        set(header_unit "${header_unit}.gcm")
+        file(GENERATE OUTPUT "${mapper}" CONTENT "${HEADER} ${header_unit}\n")
+
+        set(header_unit_command -fmodules-ts -fmodule-mapper=${mapper} -x c++-header -fmodule-header "${HEADER}"
+            -MD -MF "${header_unit}.d" -MT "${header_unit}")
+        set(import_options -fmodules-ts -fmodule-mapper=${mapper} -include "${import_header}")
+        set(depfile "${header_unit}.d")
+    elseif(CMAKE_CXX_COMPILER_ID MATCHES "Clang")
+        set(header_unit "${header_unit}.pcm")
+        set(header_unit_command -fmodule-header -xc++-header "${HEADER}" -o "${header_unit}"
+            -MD -MF "${header_unit}.d" -MT "${header_unit}")
+        set(import_options -fmodule-file=${header_unit} -include "${import_header}")
+        set(depfile "${header_unit}.d")
+    elseif(MSVC)
+        set(header_unit "${header_unit}.ifc")
+        set(header_unit_command /c /exportHeader /headerName:quote "${HEADER}" /ifcOutput "${header_unit}" /Fo${header_unit}.obj)
+        set(import_options /headerUnit:quote "${HEADER}=${header_unit}" /FI${import_header})
+    else()
+        message(FATAL_ERROR "tinyrefl_tool(TARGET ${TARGET} HEADER_UNIT): header units are not supported with ${CMAKE_CXX_COMPILER_ID}")
+    endif()
+
+    # Make and Visual Studio generators support depfiles since CMake 3.20 only
+    if(depfile AND (CMAKE_GENERATOR MATCHES "Ninja" OR NOT CMAKE_VERSION VERSION_LESS 3.20))
+        set(depfile DEPFILE "${depfile}")
+    else()
+        set(depfile)
+    endif()
+
+    file(GENERATE OUTPUT "${import_header}" CONTENT
+"// Generated by tinyrefl_tool(), do not edit
+import \"${HEADER}\";
+")
+
+    # The header unit is built after the tool runs of the target, and rebuilt
+    # when the reflected headers (and so their generated code) change
+    add_custom_command(
+        OUTPUT "${header_unit}"
+        COMMAND ${CMAKE_CXX_COMPILER} ${compile_options} ${header_unit_command}
+        DEPENDS "${HEADER}" "$<TARGET_PROPERTY:${TARGET},TINYREFL_METADATA_HEADERS>"
+        ${depfile}
+        WORKING_DIRECTORY ${CMAKE_CURRENT_BINARY_DIR}
+        COMMENT "Building tinyrefl metadata header unit for ${TARGET}"
+        COMMAND_EXPAND_LISTS
+        VERBATIM
+    )
+
+    target_sources(${TARGET} PRIVATE "${header_unit}")
+    set_property(TARGET ${TARGET} PROPERTY TINYREFL_METADATA_HEADER_UNIT "${header_unit}")
+    set_property(TARGET ${TARGET} PROPERTY TINYREFL_METADATA_IMPORT_OPTIONS ${import_options})
+endfunction()
+
+# Applies the metadata header opt-in list to the sources of a target: The
+# sources listed get the header unit import (If any), and the rest of the
+# sources skip the precompiled header
+function(tinyrefl_metadata_header_sources TARGET)
+    get_target_property(metadata_sources ${TARGET} TINYREFL_METADATA_SOURCES)
+    get_target_property(target_sources ${TARGET} SOURCES)
+    get_target_property(target_source_dir ${TARGET} SOURCE_DIR)
+    get_target_property(header_unit ${TARGET} TINYREFL_METADATA_HEADER_UNIT)
+    get_target_property(import_options ${TARGET} TINYREFL_METADATA_IMPORT_OPTIONS)
+
+    if(NOT metadata_sources)
+        set(metadata_sources)
+    endif()
+
+    set(missing_sources ${metadata_sources})
+
+    foreach(source ${target_sources})
+        get_filename_component(absolute_source "${source}" ABSOLUTE BASE_DIR "${target_source_dir}")
+
+        if(absolute_source IN_LIST metadata_sources)
+            list(REMOVE_ITEM missing_sources "${absolute_source}")
+
+            if(header_unit)
+                set_property(SOURCE "${absolute_source}" TARGET_DIRECTORY ${TARGET} APPEND PROPERTY COMPILE_OPTIONS ${import_options})
+                set_property(SOURCE "${absolute_source}" TARGET_DIRECTORY ${TARGET} APPEND PROPERTY OBJECT_DEPENDS "${header_unit}")
+            endif()
+        elseif(NOT header_unit)
+            set_property(SOURCE "${absolute_source}" TARGET_DIRECTORY ${TARGET} PROPERTY SKIP_PRECOMPILE_HEADERS ON)
+        endif()
+    endforeach()
+
+    if(missing_sources)
+        message(WARNING "PRECOMPILE_SOURCES of ${TARGET} not in the target sources: ${missing_sources}")
+    endif()
+endfunction()
@@ -1,27 +1,83 @@
+#include <algorithm>
 #include <cassert>
+#include <cctype>
+#ifdef TINYREFL_TOOL_HAS_LIBCLANG
+#include <clang-c/Index.h>
+#endif // TINYREFL_TOOL_HAS_LIBCLANG
 #include <cppast/cpp_class.hpp>
 #include <cppast/cpp_enum.hpp>
 #include <cppast/cpp_member_function.hpp>
 #include <cppast/cpp_member_variable.hpp>
 #include <cppast/cpp_type.hpp>
+#include <cppast/diagnostic_logger.hpp>
 #include <cppast/libclang_parser.hpp>
 #include <cppast/parser.hpp>
 #include <cppast/visitor.hpp>
 #include <cppfs/FileHandle.h>
+#include <cppfs/FilePath.h>
 #include <cppfs/fs.h>
+#include <cstdint>
 #include <fmt/format.h>
 #include <fmt/ostream.h>
 #include <fstream>
 #include <functional>
 #include <iostream>
 #include <llvm/Support/CommandLine.h>
+#include <llvm/Support/FileSystem.h>
+#include <memory>
 #include <regex>
 #include <sstream>
 #include <string>
+#include <tuple>
+#include <unordered_map>
 #include <unordered_set>
 
 namespace cl = llvm::cl;
 
+// When enabled the tool emits the tinyrefl::backend metadata specializations
+// directly instead of the TINYREFL_XXX() macros, saving the preprocessing of the
+// macro layer. The output only works with the default backend (backend.hpp)
+static bool direct_codegen = false;
+
+// When enabled the tool generates one file per top level class or enum,
+// with the .tinyrefl file of the header including all of them. TUs can
+// include only the metadata they need, and only the files of the entities
+// that changed are rewritten
+static bool sharded_codegen = false;
+
+// When enabled the tool computes the layout (size, alignment, offsets) of
+// the reflected classes with libclang and emits it with the metadata
+static bool layout_codegen = false;
+
+// ID map file given with --id-map. When set the tool assigns a sequential
+// integer ID to each reflected entity, persisting the assigned IDs in the
+// map so they are stable across runs
+static std::string id_map_path;
+
+std::string codegen_mode()
+{
+    return std::string{direct_codegen ? "direct" : "macros"} +
+           (sharded_codegen ? ", sharded" : "") +
+           (layout_codegen ? ", layout" : "") +
+           (id_map_path.empty() ? "" : ", ids");
+}
+
+bool generated_with_codegen_mode(std::istream& is, const std::string& mode)
+{
+    static const std::string prefix = "//   tinyrefl codegen mode: ";
+    std::string              line;
+
+    while(std::getline(is, line) && line.compare(0, 2, "//") == 0)
+    {
+        if(line.compare(0, prefix.size(), prefix) == 0)
+        {
+            return line.substr(prefix.size()) == mode;
+        }
+    }
+
+    return false;
+}
+
 bool is_outdated_file(const std::string& file)
 {
     const auto input_file  = cppfs::fs::open(file);
@@ -29,6 +85,13 @@ bool is_outdated_file(const std::string& file)
 
     assert(input_file.exists());
 
+    // IDs in the existing file are lost with the ID map, and new IDs could
+    // clash with them
+    if(!id_map_path.empty() && !cppfs::fs::open(id_map_path).exists())
+    {
+        return true;
+    }
+
     bool timestamp_outdated =
         !output_file.exists() ||
         input_file.modificationTime() > output_file.modificationTime();
@@ -55,7 +118,14 @@ bool is_outdated_file(const std::string& file)
                 std::cout << "[info] tool commit:           "
                           << TINYREFL_GIT_COMMIT << "\n";
                 std::cout << "[info] generated code commit: " << commit << "\n";
-                return commit != TINYREFL_GIT_COMMIT;
+
+                if(commit != TINYREFL_GIT_COMMIT)
+                {
+                    return true;
+                }
+
+                std::cout << "[info] checking generated code mode...\n";
+                return !generated_with_codegen_mode(*istream, codegen_mode());
             }
         }
 
@@ -264,11 +334,201 @@ std::string full_qualified_display_name(const cppast::cpp_entity& entity)
 template<typename Sequence>
 std::string typelist(const Sequence& args)
 {
-    return fmt::format("TINYREFL_SEQUENCE(({}))", sequence(args, ", "));
+    if(direct_codegen)
+    {
+        return fmt::format("::tinyrefl::meta::list<{}>", sequence(args, ", "));
+    }
+    else
+    {
+        return fmt::format("TINYREFL_SEQUENCE(({}))", sequence(args, ", "));
+    }
+}
+
+// Returns the string literal contents the preprocessor gives to
+// TINYREFL_PP_STR(str), that is, the input with whitespace sequences outside
+// string and character literals replaced by a single space
+std::string stringized(const std::string& str)
+{
+    std::string result;
+    char        literal_delimiter = '\0';
+    bool        pending_space     = false;
+
+    for(std::size_t i = 0; i < str.size(); ++i)
+    {
+        const char c = str[i];
+
+        if(literal_delimiter != '\0')
+        {
+            result += c;
+
+            if(c == '\\' && i + 1 < str.size())
+            {
+                result += str[++i];
+            }
+            else if(c == literal_delimiter)
+            {
+                literal_delimiter = '\0';
+            }
+        }
+        else if(std::isspace(static_cast<unsigned char>(c)))
+        {
+            pending_space = !result.empty();
+        }
+        else
+        {
+            if(pending_space)
+            {
+                result += ' ';
+                pending_space = false;
+            }
+
+            if(c == '"' || c == '\'')
+            {
+                literal_delimiter = c;
+            }
+
+            result += c;
+        }
+    }
+
+    return result;
+}
+
+std::string escaped_string_literal(const std::string& str)
+{
+    std::string result = "\"";
+
+    for(const char c : str)
+    {
+        if(c == '"' || c == '\\')
+        {
+            result += '\\';
+        }
+
+        result += c;
+    }
+
+    return result + "\"";
+}
+
+// Same FNV-1a hash ctti::detail::cstring::hash() computes, so direct codegen
+// can emit the string hashes the backend would compute from TINYREFL_STRING()
+std::uint64_t fnv1a_hash(const std::string& str)
+{
+    std::uint64_t hash = 14695981039346656037ull;
+
+    for(const char c : str)
+    {
+        hash = (hash ^ c) * 1099511628211ull;
+    }
+
+    return hash;
+}
+
+std::string hash_constant(const std::string& str)
+{
+    return fmt::format(
+        "::tinyrefl::backend::hash_constant<{}ull>",
+        fnv1a_hash(stringized(str)));
 }
 
 static std::unordered_set<std::string> string_registry;
 
+// In direct codegen the strings of a generated file are not defined one by
+// one but stored in a string pool, classes with a chars() function returning
+// strings null separated. Strings are referenced by chunk, offset and length
+// in the pool
+struct string_pool_chunk
+{
+    std::vector<std::string> strings;
+    std::size_t              size = 0;
+};
+
+struct string_pool
+{
+    std::string                    name;
+    std::vector<string_pool_chunk> chunks;
+    // Chunk and offset of each string
+    std::unordered_map<std::string, std::pair<std::size_t, std::size_t>>
+        offsets;
+};
+
+// Each chunk is one string literal, MSVC rejects literals longer than 64KB
+// (Error C2026). The limit counts the null terminator of the literal
+static constexpr std::size_t max_string_pool_chunk_size = 0xFFFF - 1;
+
+static string_pool strings_pool;
+
+void begin_string_pool(const std::string& filepath)
+{
+    strings_pool      = string_pool{};
+    strings_pool.name = fmt::format(
+        "string_pool_{}", std::hash<std::string>()(filepath));
+}
+
+std::string string_pool_chunk_name(const std::size_t chunk)
+{
+    return fmt::format("{}_{}", strings_pool.name, chunk);
+}
+
+std::string pooled_string(const std::string& str)
+{
+    const auto literal = stringized(str);
+    auto       it      = strings_pool.offsets.find(literal);
+
+    if(it == strings_pool.offsets.end())
+    {
+        if(strings_pool.chunks.empty() ||
+           strings_pool.chunks.back().size + literal.size() + 1 >
+               max_string_pool_chunk_size)
+        {
+            strings_pool.chunks.emplace_back();
+        }
+
+        auto&      chunk    = strings_pool.chunks.back();
+        const auto location =
+            std::make_pair(strings_pool.chunks.size() - 1, chunk.size);
+
+        chunk.strings.push_back(literal);
+        chunk.size += literal.size() + 1;
+        it = strings_pool.offsets.emplace(literal, location).first;
+    }
+
+    return fmt::format(
+        "::tinyrefl::backend::pooled_string<::tinyrefl::backend::{}, {}, {}>",
+        string_pool_chunk_name(it->second.first),
+        it->second.second,
+        literal.size());
+}
+
+void generate_string_pool(std::ostream& os)
+{
+    for(std::size_t i = 0; i < strings_pool.chunks.size(); ++i)
+    {
+        const auto& chunk = strings_pool.chunks[i];
+
+        fmt::print(
+            os,
+            "struct {}\n"
+            "{{\n"
+            "    static constexpr ::ctti::detail::cstring chars()\n"
+            "    {{\n"
+            "        return {{\n",
+            string_pool_chunk_name(i));
+
+        // One literal per string, so escapes of the null separators are not
+        // merged with the next string
+        for(const std::string& str : chunk.strings)
+        {
+            const auto literal = escaped_string_literal(str);
+            os << "            " << literal.substr(0, literal.size() - 1)
+               << "\\0\"\n";
+        }
+
+        fmt::print(os, "            , {}}};\n    }}\n}};\n\n", chunk.size);
+    }
+}
+
 void generate_string_definition(std::ostream& os, const std::string& str)
 {
     const auto hash  = std::hash<std::string>()(str);
@@ -282,6 +542,12 @@ void generate_string_definition(std::ostream& os, const std::string& str)
 
 void generate_string_definitions(std::ostream& os)
 {
+    if(direct_codegen)
+    {
+        generate_string_pool(os);
+        return;
+    }
+
     for(const std::string& str : string_registry)
     {
         generate_string_definition(os, str);
@@ -296,7 +562,35 @@ const std::string& string(const std::string& str)
 
 std::string string_constant(const std::string& str)
 {
-    return fmt::format("TINYREFL_STRING({})", string(str));
+    if(direct_codegen)
+    {
+        return pooled_string(str);
+    }
+    else
+    {
+        return fmt::format("TINYREFL_STRING({})", string(str));
+    }
+}
+
+// Strings used as keys of metadata lookups by name. Direct codegen keys are
+// just the hash of the string, with no need to store the string
+std::string string_key(const std::string& str)
+{
+    if(direct_codegen)
+    {
+        return hash_constant(str);
+    }
+    else
+    {
+        return string_constant(str);
+    }
+}
+
+// Type spellings are only registered as string constants for macro based
+// backends, the default backend never looks them up
+const std::string& type_string(const std::string& str)
+{
+    return direct_codegen ? str : string(str);
 }
 
 namespace cppast
@@ -310,7 +604,7 @@ std::ostream& operator<<(std::ostream& os, const cpp_type& type)
 
 std::string type(const cppast::cpp_member_function& function)
 {
-    return string(fmt::format(
+    return type_string(fmt::format(
         "{}({}::*){}",
         function.return_type(),
         full_qualified_name(function.parent().value()),
@@ -319,7 +613,7 @@ std::string type(const cppast::cpp_member_function& function)
 
 std::string type(const cppast::cpp_member_variable& variable)
 {
-    return string(fmt::format(
+    return type_string(fmt::format(
         "{} {}::*",
         variable.type(),
         full_qualified_name(variable.parent().value())));
@@ -327,12 +621,12 @@ std::string type(const cppast::cpp_member_variable& variable)
 
 std::string type(const cppast::cpp_entity& entity)
 {
-    return string(entity.name());
+    return type_string(entity.name());
 }
 
 std::string type(const cppast::cpp_type& type)
 {
-    return string(cppast::to_string(type));
+    return type_string(cppast::to_string(type));
 }
 
 std::string type(const cppast::cpp_enum_value& value)
@@ -352,7 +646,7 @@ std::string full_qualified_type(const cppast::cpp_member_variable& variable)
 
 std::string full_qualified_type(const cppast::cpp_entity& entity)
 {
-    return string(full_qualified_name(entity));
+    return type_string(full_qualified_name(entity));
 }
 
 std::string full_qualified_type(const cppast::cpp_type& type)
@@ -368,8 +662,17 @@ std::string full_qualified_type(const cppast::cpp_enum_value& value)
 template<typename Entity>
 std::string type_reference(const Entity& entity)
 {
-    return fmt::format(
-        "TINYREFL_TYPE(({}), ({}))", type(entity), full_qualified_type(entity));
+    if(direct_codegen)
+    {
+        return full_qualified_type(entity);
+    }
+    else
+    {
+        return fmt::format(
+            "TINYREFL_TYPE(({}), ({}))",
+            type(entity),
+            full_qualified_type(entity));
+    }
 }
 
 template<
@@ -378,10 +681,20 @@ template<
         std::enable_if_t<std::is_base_of<cppast::cpp_entity, Entity>::value>>
 std::string value(const Entity& entity)
 {
-    return fmt::format(
-        "TINYREFL_VALUE(({}), ({}))",
-        type_reference(entity),
-        full_qualified_name(entity));
+    if(direct_codegen)
+    {
+        return fmt::format(
+            "::ctti::static_value<{}, {}>",
+            type_reference(entity),
+            full_qualified_name(entity));
+    }
+    else
+    {
+        return fmt::format(
+            "TINYREFL_VALUE(({}), ({}))",
+            type_reference(entity),
+            full_qualified_name(entity));
+    }
 }
 
 std::string enum_declaration(
@@ -418,7 +731,9 @@ std::string attribute(const cppast::cpp_attribute& attribute)
     }
 
     return fmt::format(
-        "TINYREFL_ATTRIBUTE(({}), ({}), ({}), ({}))",
+        direct_codegen
+            ? "::tinyrefl::backend::attribute_metadata<{}, {}, {}, {}>"
+            : "TINYREFL_ATTRIBUTE(({}), ({}), ({}), ({}))",
         string_constant(attribute.name()),
         string_constant(namespace_),
         string_constant(full_attribute.str()),
@@ -439,6 +754,15 @@ std::string attributes(const cppast::cpp_entity& entity)
 
 std::string enum_value(const cppast::cpp_enum_value& enum_value)
 {
+    if(direct_codegen)
+    {
+        return fmt::format(
+            "::tinyrefl::backend::enum_value<{}, {}, {}>",
+            string_constant(full_qualified_name(enum_value)),
+            value(enum_value),
+            attributes(enum_value));
+    }
+
     return fmt::format(
         "TINYREFL_ENUM_VALUE(({}), ({}), ({}), ({}), ({}))",
         string_constant(enum_value.name()),
@@ -452,7 +776,8 @@ template<typename Member>
 std::string member_pointer(const Member& member)
 {
     return fmt::format(
-        "TINYREFL_VALUE(({}), (&{}))",
+        direct_codegen ? "::ctti::static_value<{}, &{}>"
+                       : "TINYREFL_VALUE(({}), (&{}))",
         type_reference(member),
         full_qualified_name(member));
 }
@@ -483,6 +808,19 @@ std::string function_parameters(const cppast::cpp_member_function& function)
 
 std::string member(const cppast::cpp_member_function& member)
 {
+    if(direct_codegen)
+    {
+        return fmt::format(
+            "::tinyrefl::backend::member_function<{}, {}, {}, {}, {}, {}, {}>",
+            string_constant(full_qualified_name(member)),
+            string_constant(display_name(member)),
+            string_constant(full_qualified_display_name(member)),
+            function_signature(member),
+            function_parameters(member),
+            member_pointer(member),
+            attributes(member));
+    }
+
     // TINYREFL_MEMBER_FUNCTION(name, fullname, parent_class_type, return_type,
     // signature, pointer, attributes)
     return fmt::format(
@@ -501,6 +839,15 @@ std::string member(const cppast::cpp_member_function& member)
 
 std::string member(const cppast::cpp_member_variable& member)
 {
+    if(direct_codegen)
+    {
+        return fmt::format(
+            "::tinyrefl::backend::member<{}, {}, {}>",
+            string_constant(full_qualified_name(member)),
+            member_pointer(member),
+            attributes(member));
+    }
+
     // TINYREFL_MEMBER_VARIABLE(name, fullname, parent_class_type, value_type,
     // pointer, attributes)
     return fmt::format(
@@ -524,9 +871,48 @@ std::string typelist_string(const std::string& str)
         "tinyrefl::meta::string<{}>", sequence(str, ", ", "'", "'"));
 }
 
-void generate_member(std::ostream& os, const std::string& member)
+// Direct codegen equivalent of the TINYREFL_REFLECT_XXX() macros: Registers
+// the metadata both by type (key) and by entity name hash
+void generate_metadata_specializations(
+    std::ostream&      os,
+    const std::string& key,
+    const std::string& name,
+    const std::string& metadata)
 {
-    fmt::print(os, "TINYREFL_REFLECT_MEMBER(({}))\n", member);
+    fmt::print(
+        os,
+        "template<>\n"
+        "struct metadata_of<{key}>\n"
+        "{{\n"
+        "    using type = {metadata};\n"
+        "}};\n"
+        "\n"
+        "template<>\n"
+        "struct metadata_of_entity_name<{name}>\n"
+        "{{\n"
+        "    using type = metadata_of_type<{key}>;\n"
+        "}};\n\n",
+        fmt::arg("key", key),
+        fmt::arg("name", name),
+        fmt::arg("metadata", metadata));
+}
+
+template<typename Member>
+void generate_member(
+    std::ostream& os, const Member& member, const std::string& metadata)
+{
+    if(direct_codegen)
+    {
+        generate_metadata_specializations(
+            os,
+            member_pointer(member),
+            string_key(full_qualified_display_name(member)),
+            metadata);
+    }
+    else
+    {
+        fmt::print(os, "TINYREFL_REFLECT_MEMBER(({}))\n", metadata);
+    }
 }
 
 bool is_unknown_entity(const cppast::cpp_entity& entity)
@@ -556,8 +942,34 @@ bool is_unknown_entity(const cppast::cpp_entity& entity)
     return false;
 }
 
+// Returns the parameter types of a "(T1, T2, ...)" signature
+std::string signature_parameters(const std::string& signature)
+{
+    const auto begin = signature.find_first_of('(');
+    const auto end   = signature.find_last_of(')');
+
+    if(begin == std::string::npos || end == std::string::npos || end < begin)
+    {
+        return "";
+    }
+    else
+    {
+        return signature.substr(begin + 1, end - begin - 1);
+    }
+}
+
 std::string constructor(const cppast::cpp_constructor& ctor)
 {
+    if(direct_codegen)
+    {
+        return fmt::format(
+            "::tinyrefl::backend::constructor<{}, {}, ::tinyrefl::meta::list<{}>, {}>",
+            string_constant(ctor.parent().value().name() + ctor.signature()),
+            type_reference(ctor.parent().value()),
+            signature_parameters(ctor.signature()),
+            attributes(ctor));
+    }
+
     return fmt::format(
         "TINYREFL_CONSTRUCTOR(({}), ({}), ({}), (TINYREFL_SEQUENCE({})), ({}))",
         string_constant(ctor.parent().value().name() + ctor.signature()),
@@ -568,13 +980,39 @@ std::string constructor(const cppast::cpp_constructor& ctor)
         attributes(ctor));
 }
 
+// Returns true if the file was written, false if it already had the
+// given contents. Untouched files keep their timestamp so the build
+// system does not rebuild their dependents
+bool write_if_changed(const std::string& filepath, const std::string& contents)
+{
+    std::ifstream is{filepath};
+
+    if(is)
+    {
+        std::ostringstream current;
+        current << is.rdbuf();
+
+        if(current.str() == contents)
+        {
+            return false;
+        }
+    }
+
+    std::ofstream{filepath} << contents;
+    return true;
+}
+
 static std::unordered_set<std::string> entities;
 
+// Full names of the entities registered for the current generated file,
+// in registration order
+static std::vector<std::string> entity_names;
+
 template<typename Entity>
 void register_entity(const Entity& entity)
 {
     bool already_registered =
-        !entities.insert(string_constant(full_qualified_display_name(entity)))
+        !entities.insert(string_key(full_qualified_display_name(entity)))
              .second;
 
     if(already_registered)
@@ -584,67 +1022,547 @@ void register_entity(const Entity& entity)
             "WARNING: An entity named \"{}\" already exists!\n",
             full_qualified_display_name(entity));
     }
+    else
+    {
+        entity_names.push_back(full_qualified_display_name(entity));
+    }
 }
 
-void generate_class(std::ostream& os, const cppast::cpp_class& class_)
+struct entity_id_entry
 {
-    std::vector<std::string> member_variables;
-    std::vector<std::string> member_functions;
-    std::vector<std::string> base_classes;
-    std::vector<std::string> enums;
-    std::vector<std::string> classes;
-    std::vector<std::string> constructors;
+    std::size_t id;
+    // Header the entity was found in, empty if unknown
+    std::string header;
+};
 
-    std::cout << " # " << full_qualified_name(class_) << " [attributes: "
-              << sequence(class_.attributes(), ", ", "\"", "\"") << "]\n";
+// Entity IDs loaded from the ID map plus the ones assigned in this run. IDs
+// of live entities never change. IDs of removed entities are retired, never
+// given to other entities, so next_entity_id only grows
+static std::unordered_map<std::string, entity_id_entry> entity_ids;
+static std::size_t                                      next_entity_id = 0;
+
+// Header being generated, and the entities it had in the ID map that were
+// not found yet
+static std::string                     id_map_header;
+static std::unordered_set<std::string> unseen_header_entities;
+
+// Entities found in the headers generated in this run, and entities missing
+// from the header they had in the ID map. Missing entities are retired at
+// the end of the run only, so entities moved to a header generated later
+// in the same run keep their ID
+static std::unordered_set<std::string> seen_entities;
+static std::unordered_set<std::string> missing_entities;
+
+// The ID map is a text file with a "next <id>" line with the next ID to
+// assign, then one "<id> <entity full name>" line per entity, grouped by
+// header with "# <header>" lines
+bool load_id_map(const std::string& filepath)
+{
+    std::ifstream is{filepath};
+    std::string   line, header;
 
-    register_entity(class_);
+    while(std::getline(is, line))
+    {
+        std::istringstream line_stream{line};
+        std::size_t        id;
+        std::string        name;
 
-    cppast::visit(
-        class_,
-        [&](const cppast::cpp_entity& child, const cppast::visitor_info& info) {
-            if(cppast::has_attribute(child, ATTRIBUTES_IGNORE) ||
-               info.is_old_entity() ||
-               info.access != cppast::cpp_access_specifier_kind::cpp_public ||
-               cppast::is_templated(child) || child.parent() != class_ ||
-               is_unknown_entity(child))
-            {
-                return;
-            }
+        if(line.empty())
+        {
+            continue;
+        }
 
-            switch(child.kind())
-            {
-            case cppast::cpp_entity_kind::member_function_t:
-            {
-                std::cout << "    - (member function) " << child.name()
-                          << " (signature: "
-                          << static_cast<const cppast::cpp_member_function&>(
-                                 child)
-                                 .signature()
-                          << ")"
-                          << " [attributes: "
-                          << sequence(child.attributes(), ", ", "\"", "\"")
-                          << "]\n";
+        if(line.compare(0, 2, "# ") == 0)
+        {
+            header = line.substr(2);
+            continue;
+        }
 
-                auto member = ::member(
-                    static_cast<const cppast::cpp_member_function&>(child));
-                member_functions.push_back(member);
-                generate_member(os, member);
-                register_entity(
-                    static_cast<const cppast::cpp_member_function&>(child));
-                break;
-            }
-            case cppast::cpp_entity_kind::member_variable_t:
-            {
-                std::cout << "    - (member variable) " << child.name()
-                          << " [attributes: "
-                          << sequence(child.attributes(), ", ", "\"", "\"")
-                          << "]\n";
+        if(line.compare(0, 5, "next ") == 0 && (line_stream >> name >> id))
+        {
+            next_entity_id = std::max(next_entity_id, id);
+            continue;
+        }
 
-                auto member = ::member(
-                    static_cast<const cppast::cpp_member_variable&>(child));
-                member_variables.push_back(member);
-                generate_member(os, member);
+        if(!(line_stream >> id) || !std::getline(line_stream >> std::ws, name))
+        {
+            std::cerr << "[error] wrong ID map " << filepath << " line: \""
+                      << line << "\"\n";
+            return false;
+        }
+
+        entity_ids[name] = {id, header};
+        next_entity_id   = std::max(next_entity_id, id + 1);
+    }
+
+    return true;
+}
+
+void save_id_map(const std::string& filepath)
+{
+    std::vector<std::tuple<std::string, std::size_t, std::string>> ids;
+
+    for(const auto& entity_id : entity_ids)
+    {
+        ids.emplace_back(
+            entity_id.second.header, entity_id.second.id, entity_id.first);
+    }
+
+    std::sort(ids.begin(), ids.end());
+    std::ostringstream os;
+
+    os << "next " << next_entity_id << "\n";
+
+    for(std::size_t i = 0; i < ids.size(); ++i)
+    {
+        if(i == 0 || std::get<0>(ids[i]) != std::get<0>(ids[i - 1]))
+        {
+            os << "\n# " << std::get<0>(ids[i]) << "\n";
+        }
+
+        os << std::get<1>(ids[i]) << " " << std::get<2>(ids[i]) << "\n";
+    }
+
+    write_if_changed(filepath, os.str());
+}
+
+// Starts the assignment of IDs to the entities of a header. The entities
+// the header had in the ID map and are not found before
+// end_header_entity_ids() are retired by retire_missing_entity_ids(), unless
+// another header of the run has them
+void begin_header_entity_ids(const std::string& header)
+{
+    id_map_header = header;
+    unseen_header_entities.clear();
+
+    for(const auto& entity_id : entity_ids)
+    {
+        if(entity_id.second.header == header)
+        {
+            unseen_header_entities.insert(entity_id.first);
+        }
+    }
+}
+
+void end_header_entity_ids()
+{
+    missing_entities.insert(
+        unseen_header_entities.begin(), unseen_header_entities.end());
+    unseen_header_entities.clear();
+    id_map_header.clear();
+}
+
+// Removes the entities missing from their header and not found in any other
+// header of the run. Their IDs are not assigned again
+void retire_missing_entity_ids()
+{
+    for(const auto& name : missing_entities)
+    {
+        if(seen_entities.count(name) == 0)
+        {
+            const auto it = entity_ids.find(name);
+
+            std::cout << "[info] entity " << name << " removed from "
+                      << it->second.header << ", ID " << it->second.id
+                      << " is retired\n";
+            entity_ids.erase(it);
+        }
+    }
+
+    missing_entities.clear();
+}
+
+std::size_t entity_id(const std::string& full_name)
+{
+    auto it = entity_ids.find(full_name);
+
+    if(it == entity_ids.end())
+    {
+        it = entity_ids
+                 .emplace(full_name, entity_id_entry{next_entity_id++, ""})
+                 .first;
+    }
+
+    // Entities moved to other headers in the same run keep their ID
+    it->second.header = id_map_header;
+    unseen_header_entities.erase(full_name);
+    seen_entities.insert(full_name);
+    return it->second.id;
+}
+
+void generate_entity_ids(std::ostream& os)
+{
+    for(const auto& name : entity_names)
+    {
+        fmt::print(
+            os,
+            direct_codegen ? "template<>\n"
+                             "struct entity_id_of_name<{}>\n"
+                             "    : public std::integral_constant<std::size_t, {}>\n"
+                             "{{\n"
+                             "}};\n\n"
+                           : "TINYREFL_ENTITY_ID(({}), ({}))\n",
+            string_key(name),
+            entity_id(name));
+    }
+}
+
+struct member_layout
+{
+    std::size_t offset;
+    std::size_t size;
+};
+
+struct class_layout
+{
+    std::size_t                                    size;
+    std::size_t                                    alignment;
+    bool                                           has_virtual_bases;
+    std::unordered_map<std::string, member_layout> members;
+};
+
+// Layout of all the classes in the translation unit being processed,
+// indexed by full qualified name
+static std::unordered_map<std::string, class_layout> layouts;
+
+#ifdef TINYREFL_TOOL_HAS_LIBCLANG
+std::string to_string(const CXString& cxstring)
+{
+    std::string result = clang_getCString(cxstring);
+    clang_disposeString(cxstring);
+    return result;
+}
+
+std::string full_qualified_name(CXCursor cursor)
+{
+    std::string result;
+
+    while(!clang_Cursor_isNull(cursor) &&
+          !clang_isTranslationUnit(clang_getCursorKind(cursor)))
+    {
+        const auto name = to_string(clang_getCursorSpelling(cursor));
+        result          = result.empty() ? name : name + "::" + result;
+        cursor          = clang_getCursorSemanticParent(cursor);
+    }
+
+    return result;
+}
+
+// Returns true if the class has virtual bases, directly or through any of
+// its bases
+bool has_virtual_bases(CXCursor class_)
+{
+    bool result = false;
+
+    clang_visitChildren(
+        class_,
+        [](CXCursor child, CXCursor, CXClientData data) {
+            auto& found = *static_cast<bool*>(data);
+
+            if(clang_getCursorKind(child) != CXCursor_CXXBaseSpecifier)
+            {
+                return CXChildVisit_Continue;
+            }
+
+            found = clang_isVirtualBase(child) ||
+                    has_virtual_bases(clang_getTypeDeclaration(
+                        clang_getCursorType(child)));
+
+            return found ? CXChildVisit_Break : CXChildVisit_Continue;
+        },
+        &result);
+
+    return result;
+}
+
+void register_layout(CXCursor class_)
+{
+    const auto type      = clang_getCursorType(class_);
+    const auto size      = clang_Type_getSizeOf(type);
+    const auto alignment = clang_Type_getAlignOf(type);
+
+    // Negative values are CXTypeLayoutError codes (Incomplete or dependent
+    // types, etc)
+    if(size < 0 || alignment < 0)
+    {
+        return;
+    }
+
+    class_layout layout{static_cast<std::size_t>(size),
+                        static_cast<std::size_t>(alignment),
+                        has_virtual_bases(class_),
+                        {}};
+
+    clang_visitChildren(
+        class_,
+        [](CXCursor child, CXCursor, CXClientData data) {
+            auto& layout = *static_cast<class_layout*>(data);
+
+            if(clang_getCursorKind(child) == CXCursor_FieldDecl &&
+               !clang_Cursor_isBitField(child))
+            {
+                const auto offset = clang_Cursor_getOffsetOfField(child);
+                const auto size =
+                    clang_Type_getSizeOf(clang_getCursorType(child));
+
+                if(offset >= 0 && size >= 0)
+                {
+                    layout.members[to_string(clang_getCursorSpelling(child))] =
+                        member_layout{static_cast<std::size_t>(offset / 8),
+                                      static_cast<std::size_t>(size)};
+                }
+            }
+
+            return CXChildVisit_Continue;
+        },
+        &layout);
+
+    layouts[full_qualified_name(class_)] = std::move(layout);
+}
+
+// Parses the file with libclang and registers the layout of all the classes
+// found in namespaces and other classes. cppast does not expose record
+// layouts nor its libclang translation unit, so this is a second parse of
+// the file. All the parses of the run share the same index
+bool compute_layouts(
+    const std::string& filepath, const std::vector<std::string>& clang_args)
+{
+    static const std::unique_ptr<void, decltype(&clang_disposeIndex)> index{
+        clang_createIndex(0, 1), clang_disposeIndex};
+
+    std::vector<const char*> args;
+
+    for(const auto& arg : clang_args)
+    {
+        args.push_back(arg.c_str());
+    }
+
+    CXTranslationUnit tu = nullptr;
+
+    const auto error = clang_parseTranslationUnit2(
+        index.get(),
+        filepath.c_str(),
+        args.data(),
+        static_cast<int>(args.size()),
+        nullptr,
+        0,
+        CXTranslationUnit_SkipFunctionBodies,
+        &tu);
+
+    if(error != CXError_Success)
+    {
+        std::cerr << "[error] libclang could not parse " << filepath
+                  << " to compute class layouts (error " << error << ")\n";
+        return false;
+    }
+
+    layouts.clear();
+
+    clang_visitChildren(
+        clang_getTranslationUnitCursor(tu),
+        [](CXCursor cursor, CXCursor, CXClientData) {
+            switch(clang_getCursorKind(cursor))
+            {
+            case CXCursor_Namespace:
+            case CXCursor_LinkageSpec:
+                return CXChildVisit_Recurse;
+            case CXCursor_StructDecl:
+            case CXCursor_ClassDecl:
+                if(clang_isCursorDefinition(cursor))
+                {
+                    register_layout(cursor);
+                }
+                return CXChildVisit_Recurse;
+            default:
+                return CXChildVisit_Continue;
+            }
+        },
+        nullptr);
+
+    clang_disposeTranslationUnit(tu);
+    return true;
+}
+#else
+bool compute_layouts(const std::string&, const std::vector<std::string>&)
+{
+    std::cerr << "[error] tinyrefl-tool was built without libclang, class "
+                 "layouts are not available\n";
+    return false;
+}
+#endif // TINYREFL_TOOL_HAS_LIBCLANG
+
+// Emits the layout of the class computed by libclang, plus static_asserts
+// checking it against the layout the compiler gives to the class
+void generate_layout(
+    std::ostream&                                          os,
+    const cppast::cpp_class&                               class_,
+    const std::vector<const cppast::cpp_member_variable*>& member_variables)
+{
+    const auto class_name = full_qualified_name(class_);
+    const auto it         = layouts.find(class_name);
+
+    if(it == layouts.end())
+    {
+        std::cout << "    [warning] layout of " << class_name
+                  << " not available\n";
+        return;
+    }
+
+    const auto&              layout = it->second;
+    std::vector<std::string> members;
+    std::ostringstream       checks;
+
+    fmt::print(
+        checks,
+        "static_assert(sizeof({class_}) == {size}, \"tinyrefl-tool computed a different sizeof({class_})\");\n"
+        "static_assert(alignof({class_}) == {alignment}, \"tinyrefl-tool computed a different alignof({class_})\");\n",
+        fmt::arg("class_", class_name),
+        fmt::arg("size", layout.size),
+        fmt::arg("alignment", layout.alignment));
+
+    for(const auto* variable : member_variables)
+    {
+        const auto member = layout.members.find(variable->name());
+
+        if(member == layout.members.end())
+        {
+            std::cout << "    [warning] layout of " << class_name
+                      << "::" << variable->name() << " not available\n";
+            continue;
+        }
+
+        members.push_back(fmt::format(
+            direct_codegen ? "::tinyrefl::backend::member_layout<{}, {}, {}>"
+                           : "TINYREFL_MEMBER_LAYOUT(({}), ({}), ({}))",
+            member_pointer(*variable),
+            member->second.offset,
+            member->second.size));
+
+        // sizeof() a reference member gives the size of the referenced type
+        if(variable->type().kind() != cppast::cpp_type_kind::reference_t)
+        {
+            fmt::print(
+                checks,
+                "static_assert(sizeof(static_cast<{class_}*>(nullptr)->{member}) == {size}, \"tinyrefl-tool computed a different size for {class_}::{member}\");\n",
+                fmt::arg("class_", class_name),
+                fmt::arg("member", variable->name()),
+                fmt::arg("size", member->second.size));
+        }
+
+        // offsetof() is not supported with virtual bases
+        if(!layout.has_virtual_bases)
+        {
+            fmt::print(
+                checks,
+                "static_assert(offsetof({class_}, {member}) == {offset}, \"tinyrefl-tool computed a different offset for {class_}::{member}\");\n",
+                fmt::arg("class_", class_name),
+                fmt::arg("member", variable->name()),
+                fmt::arg("offset", member->second.offset));
+        }
+    }
+
+    if(direct_codegen)
+    {
+        fmt::print(
+            os,
+            "template<>\n"
+            "struct layout_of<{}>\n"
+            "{{\n"
+            "    using type = ::tinyrefl::backend::class_layout<{}, {}, {}>;\n"
+            "}};\n\n",
+            type_reference(class_),
+            layout.size,
+            layout.alignment,
+            typelist(members));
+    }
+    else
+    {
+        fmt::print(
+            os,
+            "TINYREFL_REFLECT_LAYOUT(({}), ({}), ({}), ({}))\n",
+            type_reference(class_),
+            layout.size,
+            layout.alignment,
+            typelist(members));
+    }
+
+    // offsetof() of non standard layout classes is conditionally supported,
+    // fine with no virtual bases but GCC and clang warn about it
+    os << "#ifndef TINYREFL_NO_LAYOUT_CHECKS\n"
+          "#if defined(__GNUC__) || defined(__clang__)\n"
+          "#pragma GCC diagnostic push\n"
+          "#pragma GCC diagnostic ignored \"-Winvalid-offsetof\"\n"
+          "#endif\n"
+       << checks.str()
+       << "#if defined(__GNUC__) || defined(__clang__)\n"
+          "#pragma GCC diagnostic pop\n"
+          "#endif\n"
+          "#endif // TINYREFL_NO_LAYOUT_CHECKS\n\n";
+}
+
+void generate_class(std::ostream& os, const cppast::cpp_class& class_)
+{
+    std::vector<std::string> member_variables;
+    std::vector<std::string> member_functions;
+    std::vector<std::string> base_classes;
+    std::vector<std::string> enums;
+    std::vector<std::string> classes;
+    std::vector<std::string> constructors;
+    std::vector<const cppast::cpp_member_variable*> variables;
+
+    std::cout << " # " << full_qualified_name(class_) << " [attributes: "
+              << sequence(class_.attributes(), ", ", "\"", "\"") << "]\n";
+
+    register_entity(class_);
+
+    cppast::visit(
+        class_,
+        [&](const cppast::cpp_entity& child, const cppast::visitor_info& info) {
+            if(cppast::has_attribute(child, ATTRIBUTES_IGNORE) ||
+               info.is_old_entity() ||
+               info.access != cppast::cpp_access_specifier_kind::cpp_public ||
+               cppast::is_templated(child) || child.parent() != class_ ||
+               is_unknown_entity(child))
+            {
+                return;
+            }
+
+            switch(child.kind())
+            {
+            case cppast::cpp_entity_kind::member_function_t:
+            {
+                std::cout << "    - (member function) " << child.name()
+                          << " (signature: "
+                          << static_cast<const cppast::cpp_member_function&>(
+                                 child)
+                                 .signature()
+                          << ")"
+                          << " [attributes: "
+                          << sequence(child.attributes(), ", ", "\"", "\"")
+                          << "]\n";
+
+                const auto& function =
+                    static_cast<const cppast::cpp_member_function&>(child);
+                auto member = ::member(function);
+                member_functions.push_back(member);
+                generate_member(os, function, member);
+                register_entity(
+                    static_cast<const cppast::cpp_member_function&>(child));
+                break;
+            }
+            case cppast::cpp_entity_kind::member_variable_t:
+            {
+                std::cout << "    - (member variable) " << child.name()
+                          << " [attributes: "
+                          << sequence(child.attributes(), ", ", "\"", "\"")
+                          << "]\n";
+
+                const auto& variable =
+                    static_cast<const cppast::cpp_member_variable&>(child);
+                auto member = ::member(variable);
+                member_variables.push_back(member);
+                variables.push_back(&variable);
+                generate_member(os, variable, member);
                 register_entity(
                     static_cast<const cppast::cpp_member_variable&>(child));
                 break;
@@ -706,23 +1624,61 @@ void generate_class(std::ostream& os, const cppast::cpp_class& class_)
         }
     }
 
-    fmt::print(
-        os,
-        "TINYREFL_REFLECT_CLASS(({}), ({}), ({}), ({}), ({}), ({}), ({}), ({}), ({}))\n",
-        string_constant(full_qualified_name(class_)),
-        type_reference(class_),
-        typelist(base_classes),
-        typelist(constructors),
-        typelist(member_functions),
-        typelist(member_variables),
-        typelist(classes),
-        typelist(enums),
-        attributes(class_));
+    if(direct_codegen)
+    {
+        generate_metadata_specializations(
+            os,
+            type_reference(class_),
+            string_key(full_qualified_name(class_)),
+            fmt::format(
+                "::tinyrefl::backend::class_<{}, {}, {}, {}, {}, {}, {}, {}, {}>",
+                string_constant(full_qualified_name(class_)),
+                type_reference(class_),
+                typelist(base_classes),
+                typelist(constructors),
+                typelist(member_functions),
+                typelist(member_variables),
+                typelist(classes),
+                typelist(enums),
+                attributes(class_)));
+    }
+    else
+    {
+        fmt::print(
+            os,
+            "TINYREFL_REFLECT_CLASS(({}), ({}), ({}), ({}), ({}), ({}), ({}), ({}), ({}))\n",
+            string_constant(full_qualified_name(class_)),
+            type_reference(class_),
+            typelist(base_classes),
+            typelist(constructors),
+            typelist(member_functions),
+            typelist(member_variables),
+            typelist(classes),
+            typelist(enums),
+            attributes(class_));
+    }
+
+    if(layout_codegen)
+    {
+        generate_layout(os, class_, variables);
+    }
 }
 
 void generate_enum_value(std::ostream& os, const cppast::cpp_enum_value& value)
 {
-    fmt::print(os, "TINYREFL_REFLECT_ENUM_VALUE(({}))\n", enum_value(value));
+    if(direct_codegen)
+    {
+        generate_metadata_specializations(
+            os,
+            ::value(value),
+            string_key(full_qualified_name(value)),
+            enum_value(value));
+    }
+    else
+    {
+        fmt::print(
+            os, "TINYREFL_REFLECT_ENUM_VALUE(({}))\n", enum_value(value));
+    }
 }
 
 void generate_enum(std::ostream& os, const cppast::cpp_enum& enum_)
@@ -757,6 +1713,21 @@ void generate_enum(std::ostream& os, const cppast::cpp_enum& enum_)
                 }
             });
 
+        if(direct_codegen)
+        {
+            generate_metadata_specializations(
+                os,
+                type_reference(enum_),
+                string_key(full_qualified_name(enum_)),
+                fmt::format(
+                    "::tinyrefl::backend::enum_<{}, {}, {}, {}>",
+                    string_constant(full_qualified_name(enum_)),
+                    type_reference(enum_),
+                    typelist(values),
+                    attributes(enum_)));
+            return;
+        }
+
         fmt::print(
             os,
             "TINYREFL_REFLECT_ENUM(({}), ({}), ({}), ({}))\n",
@@ -767,9 +1738,10 @@ void generate_enum(std::ostream& os, const cppast::cpp_enum& enum_)
     }
 }
 
-void generate_global_metadata_list(std::ostream& os)
+void generate_global_metadata_list(
+    std::ostream& os, const std::unordered_set<std::string>& file_entities)
 {
-    const auto entities_sequence = typelist(entities);
+    const auto entities_sequence = typelist(file_entities);
 
     os << "#ifndef TINYREFL_GENERATED_FILE_COUNT\n"
           "    #define TINYREFL_GENERATED_FILE_COUNT 0\n"
@@ -781,6 +1753,9 @@ void generate_global_metadata_list(std::ostream& os)
           "\n";
 
     static constexpr int TINYREFL_TOOL_MAX_GENERATED_FILES = 128;
+    const auto entities_cat = direct_codegen
+                                  ? "::tinyrefl::meta::cat_t<TINYREFL_ENTITIES_{i}, {entities}>"
+                                  : "TINYREFL_SEQUENCE_CAT((TINYREFL_ENTITIES_{i}), ({entities}))";
 
     for(int i = 0; i <= TINYREFL_TOOL_MAX_GENERATED_FILES; ++i)
     {
@@ -791,13 +1766,18 @@ void generate_global_metadata_list(std::ostream& os)
                 "#{if} TINYREFL_GENERATED_FILE_COUNT == {i}\n"
                 "    #undef TINYREFL_GENERATED_FILE_COUNT\n"
                 "    #define TINYREFL_GENERATED_FILE_COUNT {next}\n"
-                "    #define TINYREFL_ENTITIES_{next} TINYREFL_SEQUENCE_CAT((TINYREFL_ENTITIES_{i}), ({entities}))\n"
+                "    #define TINYREFL_ENTITIES_{next} {cat}\n"
                 "    #undef TINYREFL_ENTITIES\n"
                 "    #define TINYREFL_ENTITIES TINYREFL_ENTITIES_{next}\n",
                 fmt::arg("if", (i == 0 ? "if" : "elif")),
                 fmt::arg("i", i),
                 fmt::arg("next", i + 1),
-                fmt::arg("entities", entities_sequence));
+                fmt::arg(
+                    "cat",
+                    fmt::format(
+                        entities_cat,
+                        fmt::arg("i", i),
+                        fmt::arg("entities", entities_sequence))));
         }
         else
         {
@@ -812,46 +1792,31 @@ void generate_global_metadata_list(std::ostream& os)
 }
 
 
-void visit_ast_and_generate(
-    const cppast::cpp_file& ast_root, const std::string& filepath)
-{
-    std::ofstream os{filepath + ".tinyrefl"};
+// Top level AST entities (Namespaces, classes, etc) reflected into the same
+// generated file
+using entity_list = std::vector<const cppast::cpp_entity*>;
 
-    const auto include_guard = fmt::format(
-        "TINYREFL_GENERATED_FILE_{}_INCLUDED",
-        std::hash<std::string>()(filepath));
+entity_list file_entities(const cppast::cpp_file& file)
+{
+    entity_list result;
 
-    os << "// Code generated by tinyrefl (https://github.com/Manu343726/tinyrefl)\n"
-       << "//\n"
-       << "//   tinyrefl commit: " << TINYREFL_GIT_COMMIT << "\n"
-       << "//   tinyrefl branch: " << TINYREFL_GIT_BRANCH << "\n"
-       << "//   tinyrefl version: " << TINYREFL_VERSION << "\n"
-       << "//   tinyrefl version major: " << TINYREFL_VERSION_MAJOR << "\n"
-       << "//   tinyrefl version minor: " << TINYREFL_VERSION_MINOR << "\n"
-       << "//   tinyrefl version fix: " << TINYREFL_VERSION_FIX << "\n\n"
-       << "#ifndef " << include_guard << "\n"
-       << "#define " << include_guard << "\n\n"
-       << "#define TINYREFL_TOOL_CODEGEN_VERSION_MAJOR "
-       << TINYREFL_VERSION_MAJOR << "\n"
-       << "#define TINYREFL_TOOL_CODEGEN_VERSION_MINOR "
-       << TINYREFL_VERSION_MINOR << "\n"
-       << "#define TINYREFL_TOOL_CODEGEN_VERSION_FIX " << TINYREFL_VERSION_FIX
-       << "\n"
-       << "#define TINYREFL_TOOL_CODEGEN_VERSION \"" << TINYREFL_VERSION
-       << "\"\n\n"
-       <<
-#include "metadata_header.hpp"
-       << std::endl;
+    for(const auto& entity : file)
+    {
+        result.push_back(&entity);
+    }
 
-    std::ostringstream body;
+    return result;
+}
 
+void generate_entities(std::ostream& os, const cppast::cpp_entity& root)
+{
     cppast::visit(
-        ast_root,
+        root,
         [](const cppast::cpp_entity& e) {
             return !cppast::is_templated(e) && cppast::is_definition(e) &&
                    !cppast::has_attribute(e, ATTRIBUTES_IGNORE);
         },
-        [&body](const cppast::cpp_entity& e, const cppast::visitor_info& info) {
+        [&os](const cppast::cpp_entity& e, const cppast::visitor_info& info) {
             if(info.is_new_entity() && info.access == cppast::cpp_public &&
                !is_unknown_entity(e))
             {
@@ -859,21 +1824,149 @@ void visit_ast_and_generate(
                 {
                 case cppast::cpp_entity_kind::class_t:
                     generate_class(
-                        body, static_cast<const cppast::cpp_class&>(e));
+                        os, static_cast<const cppast::cpp_class&>(e));
                     break;
                 case cppast::cpp_entity_kind::enum_t:
-                    generate_enum(
-                        body, static_cast<const cppast::cpp_enum&>(e));
+                    generate_enum(os, static_cast<const cppast::cpp_enum&>(e));
                     break;
                 default:
                     break;
                 }
             }
         });
+}
+
+// Returns the classes and enums of the file that are not nested into
+// other classes. Each one gets its own generated file in sharded mode
+entity_list top_level_entities(const entity_list& roots)
+{
+    entity_list result;
+
+    for(const auto* root : roots)
+    {
+        cppast::visit(
+            *root,
+            [](const cppast::cpp_entity& e) {
+                return !cppast::is_templated(e) && cppast::is_definition(e) &&
+                       !cppast::has_attribute(e, ATTRIBUTES_IGNORE);
+            },
+            [&result](
+                const cppast::cpp_entity& e, const cppast::visitor_info& info) {
+                if(info.is_new_entity() &&
+                   info.access == cppast::cpp_public &&
+                   !is_unknown_entity(e) &&
+                   (e.kind() == cppast::cpp_entity_kind::class_t ||
+                    e.kind() == cppast::cpp_entity_kind::enum_t) &&
+                   !(e.parent().has_value() &&
+                     e.parent().value().kind() ==
+                         cppast::cpp_entity_kind::class_t))
+                {
+                    result.push_back(&e);
+                }
+            });
+    }
+
+    return result;
+}
+
+void generate_file_header(std::ostream& os)
+{
+    os << "// Code generated by tinyrefl (https://github.com/Manu343726/tinyrefl)\n"
+       << "//\n"
+       << "//   tinyrefl commit: " << TINYREFL_GIT_COMMIT << "\n"
+       << "//   tinyrefl branch: " << TINYREFL_GIT_BRANCH << "\n"
+       << "//   tinyrefl version: " << TINYREFL_VERSION << "\n"
+       << "//   tinyrefl version major: " << TINYREFL_VERSION_MAJOR << "\n"
+       << "//   tinyrefl version minor: " << TINYREFL_VERSION_MINOR << "\n"
+       << "//   tinyrefl version fix: " << TINYREFL_VERSION_FIX << "\n"
+       << "//   tinyrefl codegen mode: " << codegen_mode() << "\n\n";
+}
+
+// Writes a complete generated file with the given metadata body. The
+// strings and entities registered while generating the body are consumed.
+// Shards leave the entities out of the global metadata list, their umbrella
+// lists the entities of all of them at once
+void generate_file(
+    std::ostream&      os,
+    const std::string& filepath,
+    const std::string& body,
+    const bool         global_metadata_list = true)
+{
+    const auto include_guard = fmt::format(
+        "TINYREFL_GENERATED_FILE_{}_INCLUDED",
+        std::hash<std::string>()(filepath));
+
+    generate_file_header(os);
+
+    os << "#ifndef " << include_guard << "\n"
+       << "#define " << include_guard << "\n\n";
+
+    if(direct_codegen)
+    {
+        os << "#ifndef TINYREFL_BACKEND_HPP\n"
+              "    #error \"This file was generated in direct codegen mode, which targets the default tinyrefl backend only. Include <tinyrefl/backend.hpp> first\"\n"
+              "#endif // TINYREFL_BACKEND_HPP\n\n";
+    }
+
+    os << "#define TINYREFL_TOOL_CODEGEN_VERSION_MAJOR "
+       << TINYREFL_VERSION_MAJOR << "\n"
+       << "#define TINYREFL_TOOL_CODEGEN_VERSION_MINOR "
+       << TINYREFL_VERSION_MINOR << "\n"
+       << "#define TINYREFL_TOOL_CODEGEN_VERSION_FIX " << TINYREFL_VERSION_FIX
+       << "\n"
+       << "#define TINYREFL_TOOL_CODEGEN_VERSION \"" << TINYREFL_VERSION
+       << "\"\n\n"
+       <<
+#include "metadata_header.hpp"
+       << std::endl;
+
+    if(layout_codegen)
+    {
+        // offsetof() in the layout checks
+        os << "#include <cstddef>\n\n";
+    }
+
+    if(layout_codegen && !direct_codegen)
+    {
+        // Layout macros are optional, backends not supporting layout
+        // metadata just get the static_assert checks
+        os << "#ifndef TINYREFL_MEMBER_LAYOUT\n"
+              "    #define TINYREFL_MEMBER_LAYOUT(...)\n"
+              "#endif // TINYREFL_MEMBER_LAYOUT\n\n"
+              "#ifndef TINYREFL_REFLECT_LAYOUT\n"
+              "    #define TINYREFL_REFLECT_LAYOUT(...)\n"
+              "#endif // TINYREFL_REFLECT_LAYOUT\n\n";
+    }
+
+    if(!id_map_path.empty() && !direct_codegen)
+    {
+        os << "#ifndef TINYREFL_ENTITY_ID\n"
+              "    #define TINYREFL_ENTITY_ID(...)\n"
+              "#endif // TINYREFL_ENTITY_ID\n\n";
+    }
+
+    if(direct_codegen)
+    {
+        os << "namespace tinyrefl\n{\nnamespace backend\n{\n\n";
+    }
 
     generate_string_definitions(os);
-    os << body.str();
-    generate_global_metadata_list(os);
+    os << body;
+
+    if(!id_map_path.empty())
+    {
+        generate_entity_ids(os);
+    }
+
+    if(direct_codegen)
+    {
+        os << "} // namespace backend\n} // namespace tinyrefl\n\n";
+    }
+
+    if(global_metadata_list)
+    {
+        generate_global_metadata_list(os, entities);
+    }
 
     os << "\n#undef TINYREFL_TOOL_CODEGEN_VERSION_MAJOR\n"
           "#undef TINYREFL_TOOL_CODEGEN_VERSION_MINOR\n"
@@ -882,7 +1975,164 @@ void visit_ast_and_generate(
 
     os << "\n#endif // " << include_guard << "\n";
 
+    string_registry.clear();
+    entities.clear();
+    entity_names.clear();
+}
+
+// Returns the file name of the shard of the given top level entity, as
+// "<header>.<full::qualified::name with '.' separators>.tinyrefl"
+std::string shard_filepath(
+    const std::string& filepath, const cppast::cpp_entity& entity)
+{
+    return filepath + "." +
+           std::regex_replace(
+               full_qualified_name(entity), std::regex{"::"}, ".") +
+           ".tinyrefl";
+}
+
+// Returns the shard files included by the existing .tinyrefl file of the
+// header, if any
+std::vector<std::string> previous_shards(const std::string& filepath)
+{
+    static const std::regex shard_include{R"(^#include "([^"]+)"$)"};
+
+    const cppfs::FilePath    path{filepath};
+    const auto               directory = path.directoryPath();
+    const auto               prefix    = path.fileName() + ".";
+    std::vector<std::string> result;
+    std::ifstream            is{filepath + ".tinyrefl"};
+    std::string              line;
+    std::smatch              match;
+
+    while(std::getline(is, line))
+    {
+        if(std::regex_match(line, match, shard_include) &&
+           match[1].str().compare(0, prefix.size(), prefix) == 0)
+        {
+            result.push_back(directory + match[1].str());
+        }
+    }
+
+    return result;
+}
+
+// Removes the shards of a previous run that are not generated anymore
+// (Entities removed from the header, or sharded mode disabled)
+void remove_stale_shards(
+    const std::vector<std::string>&        shards,
+    const std::unordered_set<std::string>& current_shards)
+{
+    for(const auto& shard : shards)
+    {
+        if(current_shards.count(shard) == 0)
+        {
+            auto file = cppfs::fs::open(shard);
+
+            if(file.exists() && file.remove())
+            {
+                std::cout << "Removed stale shard " << shard << "\n";
+            }
+        }
+    }
+}
+
+void generate_header(
+    const entity_list& ast_roots, const std::string& filepath)
+{
+    const auto old_shards = previous_shards(filepath);
+
+    if(!sharded_codegen)
+    {
+        std::ostringstream body;
+        begin_string_pool(filepath);
+
+        for(const auto* root : ast_roots)
+        {
+            generate_entities(body, *root);
+        }
+
+        std::ofstream os{filepath + ".tinyrefl"};
+        generate_file(os, filepath, body.str());
+        os.close();
+
+        remove_stale_shards(old_shards, {});
+
+        std::cout << "Done. Metadata saved in " << filepath << ".tinyrefl\n";
+        return;
+    }
+
+    // In sharded mode the .tinyrefl file is just an umbrella including the
+    // generated file of each top level class and enum
+    const auto include_guard = fmt::format(
+        "TINYREFL_GENERATED_FILE_{}_INCLUDED",
+        std::hash<std::string>()(filepath));
+
+    std::ostringstream              os;
+    std::unordered_set<std::string> shards;
+    std::unordered_set<std::string> header_entities;
+
+    generate_file_header(os);
+
+    os << "#ifndef " << include_guard << "\n"
+       << "#define " << include_guard << "\n\n";
+
+    for(const auto* entity : top_level_entities(ast_roots))
+    {
+        const auto shard = shard_filepath(filepath, *entity);
+
+        std::ostringstream body;
+        begin_string_pool(shard);
+        generate_entities(body, *entity);
+        header_entities.insert(entities.begin(), entities.end());
+
+        std::ostringstream contents;
+        generate_file(contents, shard, body.str(), false);
+
+        if(write_if_changed(shard, contents.str()))
+        {
+            std::cout << "Metadata of " << full_qualified_name(*entity)
+                      << " saved in " << shard << "\n";
+        }
+        else
+        {
+            std::cout << "Metadata of " << full_qualified_name(*entity)
+                      << " is up to date (" << shard << ")\n";
+        }
+
+        shards.insert(shard);
+        os << "#include \"" << cppfs::FilePath{shard}.fileName() << "\"\n";
+    }
+
+    // One entry in the global metadata list for the whole header, so the
+    // shards do not count towards the generated files limit
+    os << "\n";
+    generate_global_metadata_list(os, header_entities);
+
+    os << "#endif // " << include_guard << "\n";
+
+    // Unlike the shards, the umbrella is always written. Its timestamp tells
+    // is_outdated_file() the header was processed, so it is not parsed again
+    // in the next build
+    std::ofstream{filepath + ".tinyrefl"} << os.str();
     std::cout << "Done. Metadata saved in " << filepath << ".tinyrefl\n";
+
+    remove_stale_shards(old_shards, shards);
+}
+
+void visit_ast_and_generate(
+    const entity_list& ast_roots, const std::string& filepath)
+{
+    if(id_map_path.empty())
+    {
+        generate_header(ast_roots, filepath);
+    }
+    else
+    {
+        begin_header_entity_ids(filepath);
+        generate_header(ast_roots, filepath);
+        end_header_entity_ids();
+    }
 }
 
 cppast::cpp_standard get_cpp_standard(const std::string& cpp_standard)
@@ -950,29 +2200,24 @@ std::istream&
     return is;
 }
 
-bool reflect_file(
-    const std::string&              filepath,
+using parser_t = cppast::simple_file_parser<cppast::libclang_parser>;
+
+parser_t::config make_parser_config(
     const cppast::cpp_standard      cpp_standard,
     cl::list<std::string>&          include_dirs,
     cl::list<std::string>&          definitions,
     cl::list<std::string>&          warnings,
     const std::vector<std::string>& custom_flags,
-    const std::string&              clang_binary)
+    const std::string&              clang_binary,
+    std::vector<std::string>&       clang_args)
 {
-    using parser_t = cppast::simple_file_parser<cppast::libclang_parser>;
-
-    if(!is_outdated_file(filepath))
-    {
-        std::cout << "file " << filepath
-                  << " metadata is up to date, skipping\n";
-        return true;
-    }
-
-    cppast::cpp_entity_index index;
-    parser_t                 parser{type_safe::ref(index)};
-    parser_t::config         config;
+    parser_t::config config;
     config.set_flags(cpp_standard);
 
+    // Same flags for the libclang layout parse
+    clang_args = {
+        "-x", "c++", "-std=" + std::string{cppast::to_string(cpp_standard)}};
+
     if(!clang_binary.empty())
     {
         if(!config.set_clang_binary(clang_binary))
@@ -984,8 +2229,7 @@ bool reflect_file(
         }
     }
 
-    std::cout << "parsing file " << filepath << " "
-              << cppast::to_string(cpp_standard) << " ";
+    std::cout << cppast::to_string(cpp_standard) << " ";
 
     // Add definitions to identify that the translation unit
     // is being parsed by tinyrefl-tool
@@ -1004,6 +2248,7 @@ bool reflect_file(
         else
         {
             config.define_macro(def.macro, def.value);
+            clang_args.push_back("-D" + def.macro + "=" + def.value);
         }
     }
 
@@ -1018,6 +2263,7 @@ bool reflect_file(
         else
         {
             config.add_include_dir(include_dir);
+            clang_args.push_back("-I" + include_dir);
         }
     }
 
@@ -1026,12 +2272,14 @@ bool reflect_file(
         auto warning_flag = "-W" + warning;
         std::cout << warning_flag << " ";
         config.add_flag(warning_flag);
+        clang_args.push_back(warning_flag);
     }
 
     for(const auto& flag : custom_flags)
     {
         std::cout << flag << " ";
         config.add_flag(flag);
+        clang_args.push_back(flag);
     }
 
 
@@ -1039,7 +2287,44 @@ bool reflect_file(
     std::cout << " -Qunused-arguments -Wno-unknown-warning-option";
     config.add_flag("-Qunused-arguments");
     config.add_flag("-Wno-unknown-warning-option");
-    std::cout << " ...\n";
+    clang_args.push_back("-Qunused-arguments");
+    clang_args.push_back("-Wno-unknown-warning-option");
+
+    return config;
+}
+
+// Returns true if there are classes to reflect in the entities, so files
+// with enums only skip the libclang layout parse
+bool has_classes(const entity_list& roots)
+{
+    bool result = false;
+
+    for(const auto* root : roots)
+    {
+        cppast::visit(
+            *root,
+            [](const cppast::cpp_entity& e) {
+                return !cppast::is_templated(e) && cppast::is_definition(e) &&
+                       !cppast::has_attribute(e, ATTRIBUTES_IGNORE);
+            },
+            [&result](
+                const cppast::cpp_entity& e, const cppast::visitor_info& info) {
+                result = result ||
+                         (info.is_new_entity() &&
+                          e.kind() == cppast::cpp_entity_kind::class_t);
+            });
+    }
+
+    return result;
+}
+
+bool reflect_file(
+    const std::string&              filepath,
+    const parser_t::config&         config,
+    const std::vector<std::string>& clang_args)
+{
+    cppast::cpp_entity_index index;
+    parser_t                 parser{type_safe::ref(index)};
 
     try
     {
@@ -1047,7 +2332,15 @@ bool reflect_file(
 
         if(file.has_value())
         {
-            visit_ast_and_generate(file.value(), filepath);
+            const auto roots = file_entities(file.value());
+
+            if(layout_codegen && has_classes(roots) &&
+               !compute_layouts(filepath, clang_args))
+            {
+                return false;
+            }
+
+            visit_ast_and_generate(roots, filepath);
             return true;
         }
         else
@@ -1063,6 +2356,449 @@ bool reflect_file(
     return false;
 }
 
+static const std::string synthetic_tu_marker =
+    "__tinyrefl_synthetic_tu_header_";
+
+// Preprocessor directives of a file relevant to merge it in a synthetic
+// translation unit
+struct header_directives
+{
+    // Files included by the file, resolved as the compiler does
+    std::vector<std::string> includes;
+    // Whether the file defines macros other than its include guard or has
+    // using directives, which would change how the headers after it parse
+    bool leaks_state = false;
+};
+
+// Returns the given directive (As "include", "define", etc) and its
+// argument if the line is a preprocessor directive
+bool parse_directive(
+    const std::string& line, std::string& directive, std::string& argument)
+{
+    std::istringstream is{line};
+    char               hash = 0;
+
+    if(!(is >> hash) || hash != '#' || !(is >> directive))
+    {
+        return false;
+    }
+
+    std::getline(is >> std::ws, argument);
+    return true;
+}
+
+// Resolves an #include directive argument of the given file to the path of
+// the included file, searching the directory of the file first for quoted
+// includes and then the include directories. Returns an empty string if the
+// include cannot be resolved (Computed includes, etc)
+std::string resolve_include(
+    const std::string&              includer,
+    const std::string&              argument,
+    const std::vector<std::string>& include_dirs)
+{
+    if(argument.size() < 2 ||
+       (argument.front() != '"' && argument.front() != '<'))
+    {
+        return "";
+    }
+
+    const auto close = argument.find(argument.front() == '"' ? '"' : '>', 1);
+
+    if(close == std::string::npos)
+    {
+        return "";
+    }
+
+    const auto               included = argument.substr(1, close - 1);
+    std::vector<std::string> candidates;
+
+    if(argument.front() == '"')
+    {
+        candidates.push_back(
+            cppfs::FilePath{includer}.directoryPath() + included);
+    }
+
+    for(const auto& include_dir : include_dirs)
+    {
+        candidates.push_back(include_dir + "/" + included);
+    }
+
+    for(const auto& candidate : candidates)
+    {
+        if(llvm::sys::fs::is_regular_file(candidate))
+        {
+            return candidate;
+        }
+    }
+
+    return "";
+}
+
+const header_directives& scan_directives(
+    const std::string& file, const std::vector<std::string>& include_dirs)
+{
+    static std::unordered_map<std::string, header_directives> cache;
+
+    const auto it = cache.find(file);
+
+    if(it != cache.end())
+    {
+        return it->second;
+    }
+
+    header_directives result;
+    std::ifstream     is{file};
+    std::string       line, directive, argument, include_guard;
+    bool              first_directive = true;
+
+    while(std::getline(is, line))
+    {
+        if(parse_directive(line, directive, argument))
+        {
+            if(directive == "include")
+            {
+                const auto included =
+                    resolve_include(file, argument, include_dirs);
+
+                if(!included.empty())
+                {
+                    result.includes.push_back(included);
+                }
+            }
+            else if(directive == "ifndef" && first_directive)
+            {
+                include_guard = argument;
+            }
+            else if(directive == "define")
+            {
+                const auto macro = argument.substr(
+                    0, argument.find_first_of(" \t("));
+
+                result.leaks_state =
+                    result.leaks_state || macro != include_guard;
+            }
+
+            // Only the #define right after the first #ifndef is the guard
+            if(directive != "ifndef" || !first_directive)
+            {
+                include_guard.clear();
+            }
+
+            first_directive = false;
+        }
+        else if(line.find("using namespace") != std::string::npos)
+        {
+            result.leaks_state = true;
+        }
+    }
+
+    return cache[file] = std::move(result);
+}
+
+// Returns true if the file includes the header, directly or through other
+// includes
+bool includes_header(
+    const std::string&               file,
+    const std::string&               header,
+    const std::vector<std::string>&  include_dirs,
+    std::unordered_set<std::string>& visited)
+{
+    if(!visited.insert(file).second)
+    {
+        return false;
+    }
+
+    for(const auto& included : scan_directives(file, include_dirs).includes)
+    {
+        bool same_file = false;
+
+        if((!llvm::sys::fs::equivalent(included, header, same_file) &&
+            same_file) ||
+           includes_header(included, header, include_dirs, visited))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// Returns true if the header can be parsed in the same synthetic
+// translation unit as the others: Headers included by other headers would
+// be skipped by their include guard when merged, and headers defining
+// macros or with using directives would change the parsing of the next ones
+bool can_be_merged(
+    const std::string&              header,
+    const std::vector<std::string>& headers,
+    const std::vector<std::string>& include_dirs)
+{
+    if(scan_directives(header, include_dirs).leaks_state)
+    {
+        return false;
+    }
+
+    std::unordered_set<std::string> visited;
+
+    for(const auto& includer : headers)
+    {
+        if(includer != header &&
+           includes_header(includer, header, include_dirs, visited))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Header contents start line in the synthetic translation unit
+struct synthetic_tu_header
+{
+    std::string filepath;
+    unsigned    first_line;
+};
+
+// Reports the diagnostics of the synthetic translation unit with the
+// location in the original headers
+class synthetic_tu_logger final : public cppast::diagnostic_logger
+{
+public:
+    synthetic_tu_logger(
+        std::string synthetic_tu, std::vector<synthetic_tu_header> headers)
+        : _synthetic_tu{std::move(synthetic_tu)}, _headers{std::move(headers)}
+    {
+    }
+
+private:
+    bool do_log(const char* source, const cppast::diagnostic& d) const override
+    {
+        if(d.location.file.value_or("") != _synthetic_tu ||
+           !d.location.line.has_value())
+        {
+            return cppast::default_logger()->log(source, d);
+        }
+
+        const unsigned line   = d.location.line.value();
+        const auto     header = std::find_if(
+            _headers.rbegin(),
+            _headers.rend(),
+            [line](const synthetic_tu_header& candidate) {
+                return candidate.first_line <= line;
+            });
+
+        if(header == _headers.rend())
+        {
+            return cppast::default_logger()->log(source, d);
+        }
+
+        auto remapped     = d;
+        remapped.location = cppast::source_location::make_file(
+            header->filepath,
+            line - header->first_line + 1,
+            d.location.column);
+        return cppast::default_logger()->log(source, remapped);
+    }
+
+    std::string                      _synthetic_tu;
+    std::vector<synthetic_tu_header> _headers;
+};
+
+// Parses all the given headers at once from a synthetic translation unit
+// with the contents of all of them, then generates the code of each header
+// from the entities found between its marker and the next one. cppast only
+// reports the entities spelled in the main file, so the contents are pasted
+// instead of #included. #pragma once lines are blanked (The headers are
+// pasted once, see can_be_merged()) keeping the line numbers of the headers
+// for diagnostics
+bool reflect_files(
+    const std::vector<std::string>& filepaths,
+    parser_t::config                config,
+    std::vector<std::string>        clang_args)
+{
+    static const std::regex pragma_once{R"(^\s*#\s*pragma\s+once\b)"};
+
+    llvm::SmallString<128> synthetic_tu;
+
+    if(llvm::sys::fs::createTemporaryFile(
+           "tinyrefl-tool-synthetic-tu", "cpp", synthetic_tu))
+    {
+        std::cerr << "[error] cannot create synthetic translation unit\n";
+        return false;
+    }
+
+    std::vector<synthetic_tu_header> headers;
+
+    {
+        std::ofstream os{synthetic_tu.str().str()};
+        unsigned      current_line = 1;
+
+        for(std::size_t i = 0; i < filepaths.size(); ++i)
+        {
+            std::ifstream is{filepaths[i]};
+            std::string   line;
+
+            os << "namespace " << synthetic_tu_marker << i << "{}\n";
+            headers.push_back({filepaths[i], ++current_line});
+
+            while(std::getline(is, line))
+            {
+                os << (std::regex_search(line, pragma_once) ? "" : line)
+                   << "\n";
+                ++current_line;
+            }
+
+            // Headers are no longer in their directory, keep their
+            // relative #include "" directives working
+            const auto directory =
+                cppfs::FilePath{filepaths[i]}.directoryPath();
+            config.add_flag("-iquote" + (directory.empty() ? "." : directory));
+            clang_args.push_back(
+                "-iquote" + (directory.empty() ? "." : directory));
+        }
+    }
+
+    const synthetic_tu_logger logger{synthetic_tu.str().str(), headers};
+    cppast::cpp_entity_index  index;
+    parser_t parser{type_safe::ref(index), type_safe::ref(logger)};
+    bool     result = false;
+
+    try
+    {
+        auto file = parser.parse(synthetic_tu.str().str(), config);
+
+        if(file.has_value())
+        {
+            std::vector<entity_list> headers_entities(filepaths.size());
+            std::size_t              current_header = 0;
+
+            for(const auto& entity : file.value())
+            {
+                if(entity.kind() == cppast::cpp_entity_kind::namespace_t &&
+                   entity.name().compare(
+                       0, synthetic_tu_marker.size(), synthetic_tu_marker) == 0)
+                {
+                    current_header = std::stoul(
+                        entity.name().substr(synthetic_tu_marker.size()));
+                }
+                else
+                {
+                    headers_entities[current_header].push_back(&entity);
+                }
+            }
+
+            if(layout_codegen && has_classes(file_entities(file.value())) &&
+               !compute_layouts(synthetic_tu.str().str(), clang_args))
+            {
+                llvm::sys::fs::remove(synthetic_tu);
+                return false;
+            }
+
+            for(std::size_t i = 0; i < filepaths.size(); ++i)
+            {
+                visit_ast_and_generate(headers_entities[i], filepaths[i]);
+            }
+
+            result = true;
+        }
+        else
+        {
+            std::cerr << "error parsing synthetic translation unit\n";
+        }
+    }
+    catch(const cppast::libclang_error& error)
+    {
+        std::cerr << "[error] " << error.what() << "\n";
+    }
+
+    llvm::sys::fs::remove(synthetic_tu);
+    return result;
+}
+
+bool reflect_files(
+    const std::vector<std::string>& filepaths,
+    const cppast::cpp_standard      cpp_standard,
+    cl::list<std::string>&          include_dirs,
+    cl::list<std::string>&          definitions,
+    cl::list<std::string>&          warnings,
+    const std::vector<std::string>& custom_flags,
+    const std::string&              clang_binary)
+{
+    std::vector<std::string> outdated;
+
+    for(const auto& filepath : filepaths)
+    {
+        if(is_outdated_file(filepath))
+        {
+            outdated.push_back(filepath);
+        }
+        else
+        {
+            std::cout << "file " << filepath
+                      << " metadata is up to date, skipping\n";
+        }
+    }
+
+    if(outdated.empty())
+    {
+        return true;
+    }
+
+    std::vector<std::string> batch;
+    std::vector<std::string> standalone;
+
+    const std::vector<std::string> include_dirs_list{
+        include_dirs.begin(), include_dirs.end()};
+
+    for(const auto& filepath : outdated)
+    {
+        if(outdated.size() > 1 &&
+           can_be_merged(filepath, outdated, include_dirs_list))
+        {
+            batch.push_back(filepath);
+        }
+        else
+        {
+            standalone.push_back(filepath);
+        }
+    }
+
+    if(batch.size() == 1)
+    {
+        standalone.push_back(batch.front());
+        batch.clear();
+    }
+
+    std::cout << "parsing files ";
+    std::vector<std::string> clang_args;
+    const auto               config = make_parser_config(
+        cpp_standard,
+        include_dirs,
+        definitions,
+        warnings,
+        custom_flags,
+        clang_binary,
+        clang_args);
+    std::cout << " ...\n";
+
+    bool result = true;
+
+    if(!batch.empty())
+    {
+        std::cout << "parsing " << batch.size()
+                  << " files in one synthetic translation unit: "
+                  << sequence(batch, ", ") << "\n";
+        result = reflect_files(batch, config, clang_args) && result;
+    }
+
+    for(const auto& filepath : standalone)
+    {
+        std::cout << "parsing file " << filepath << "\n";
+        result = reflect_file(filepath, config, clang_args) && result;
+    }
+
+    return result;
+}
+
 template<typename Stream>
 void print_version(Stream& out)
 {
@@ -1080,8 +2816,11 @@ void print_version(Stream& out)
 
 int main(int argc, char** argv)
 {
-    cl::opt<std::string> filename{
-        cl::Positional, cl::desc("<input header>"), cl::Required};
+    cl::list<std::string> filenames{
+        cl::Positional,
+        cl::desc(
+            "<input headers>. Multiple headers are parsed at once from a synthetic translation unit"),
+        cl::OneOrMore};
     cl::list<std::string> includes{
         "I", cl::Prefix, cl::ValueOptional, cl::desc("Include directories")};
     cl::list<std::string> definitions{
@@ -1109,6 +2848,23 @@ int main(int argc, char** argv)
         cl::ValueOptional,
         cl::desc(
             "clang++ binary. If not given, tinyrefl-tool will search in your PATH")};
+    cl::opt<bool> sharded_codegen_flag{
+        "sharded-codegen",
+        cl::desc(
+            "Generate one file per top level class or enum, plus an umbrella <input header>.tinyrefl file including all of them")};
+    cl::opt<bool> layout_flag{
+        "layout",
+        cl::desc(
+            "Compute the layout (size, alignment, member offsets) of reflected classes with libclang and generate it with the metadata, plus static_asserts checking it")};
+    cl::opt<std::string> id_map{
+        "id-map",
+        cl::ValueRequired,
+        cl::desc(
+            "Assign sequential integer IDs to the reflected entities, persisting them in the given ID map file")};
+    cl::opt<bool> direct_codegen_flag{
+        "direct-codegen",
+        cl::desc(
+            "Generate tinyrefl::backend metadata specializations directly instead of TINYREFL_XXX() macros. Output only works with the default tinyrefl backend")};
 
 #if TINYREFL_LLVM_VERSION_MAJOR >= 6
     cl::SetVersionPrinter([](llvm::raw_ostream& out) { print_version(out); });
@@ -1118,8 +2874,27 @@ int main(int argc, char** argv)
 
     if(cl::ParseCommandLineOptions(argc, argv, "Tinyrefl codegen tool"))
     {
-        if(reflect_file(
-               filename,
+        direct_codegen  = direct_codegen_flag;
+        sharded_codegen = sharded_codegen_flag;
+        layout_codegen  = layout_flag;
+        id_map_path     = id_map;
+
+#ifndef TINYREFL_TOOL_HAS_LIBCLANG
+        if(layout_codegen)
+        {
+            std::cerr << "[error] --layout is not available, tinyrefl-tool "
+                         "was built without libclang\n";
+            return 1;
+        }
+#endif // TINYREFL_TOOL_HAS_LIBCLANG
+
+        if(!id_map_path.empty() && !load_id_map(id_map_path))
+        {
+            return 1;
+        }
+
+        if(reflect_files(
+               filenames,
                stdversion,
                includes,
                definitions,
@@ -1127,6 +2902,12 @@ int main(int argc, char** argv)
                custom_flags,
                clang_binary))
         {
+            if(!id_map_path.empty())
+            {
+                retire_missing_entity_ids();
+                save_id_map(id_map_path);
+            }
+
             return 0;
         }
         else